@@ -0,0 +1,310 @@
+/**
+ * File:        actor.c
+ * Purpose:     Actor pool, stored as one array per field
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "actor.h"
+
+// Generations wrap within the bits left over by the slot index
+#define ACTOR_GEN_MASK ((1 << (32 - ACTOR_INDEX_BITS)) - 1)
+
+// Actors of the simulation
+SIM_LOCAL ACTORPOOL g_sActors = { 0, 0, 0, -1 };
+
+// Every column of the pool, by offset into it, with the size of one element
+typedef struct ACTORCOLUMN
+{
+	size_t offset;
+	size_t size;
+} ACTORCOLUMN;
+
+static const ACTORCOLUMN s_aColumns[] = {
+    { offsetof(ACTORPOOL, x), sizeof(int) },
+    { offsetof(ACTORPOOL, y), sizeof(int) },
+    { offsetof(ACTORPOOL, oldx), sizeof(int) },
+    { offsetof(ACTORPOOL, oldy), sizeof(int) },
+    { offsetof(ACTORPOOL, jump), sizeof(int) },
+    { offsetof(ACTORPOOL, dir), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, moving), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, jumpqueued), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, used), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, alive), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, active), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, kind), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, w), sizeof(short) },
+    { offsetof(ACTORPOOL, h), sizeof(short) },
+    { offsetof(ACTORPOOL, owed), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, frame), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, maxframe), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, framecount), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, framedelay), sizeof(unsigned char) },
+    { offsetof(ACTORPOOL, region), sizeof(int) },
+    { offsetof(ACTORPOOL, rnext), sizeof(int) },
+    { offsetof(ACTORPOOL, rprev), sizeof(int) },
+    { offsetof(ACTORPOOL, gen), sizeof(unsigned short) },
+    { offsetof(ACTORPOOL, nextfree), sizeof(int) }
+};
+
+#define NUM_COLUMNS (sizeof(s_aColumns) / sizeof(s_aColumns[0]))
+
+// Column pointer of the pool
+#define COLUMN(i) ((void ** )((char * ) & g_sActors + s_aColumns[i].offset))
+
+/**
+ * Makes room for at least nCap actors, keeping the ones there are
+ *
+ * Parameters:
+ * nCap			Number of actors needed
+ */
+int actorReserve(int nCap) {
+    void * pNew;
+    size_t i;
+    int nNewCap;
+
+    if (nCap <= g_sActors.cap)
+        return 0;
+
+    if (nCap > ACTOR_INDEX_MASK + 1)
+        return -1;
+
+    nNewCap = g_sActors.cap ? g_sActors.cap : 64;
+    while (nNewCap < nCap)
+        nNewCap *= 2;
+
+    for (i = 0; i < NUM_COLUMNS; i++) {
+        pNew = realloc( * COLUMN(i), nNewCap * s_aColumns[i].size);
+        if (pNew == NULL)
+            return -1;
+
+        // New slots start out zeroed, generation included
+        memset((char * ) pNew + g_sActors.cap * s_aColumns[i].size, 0, (nNewCap - g_sActors.cap) * s_aColumns[i].size);
+        * COLUMN(i) = pNew;
+    }
+
+    g_sActors.cap = nNewCap;
+    return 0;
+}
+
+/**
+ * Removes every actor, keeping the memory. Generations carry on, so
+ * handles from before stay stale.
+ */
+void actorClear(void) {
+    int i;
+
+    for (i = 0; i < g_sActors.count; i++)
+        if (g_sActors.used[i])
+            g_sActors.gen[i] = (g_sActors.gen[i] + 1) & ACTOR_GEN_MASK;
+
+    // Slots are handed out from the start again, in order
+    if (g_sActors.cap > 0)
+        memset(g_sActors.used, 0, g_sActors.cap);
+
+    g_sActors.count = 0;
+    g_sActors.live = 0;
+    g_sActors.freelist = -1;
+}
+
+/**
+ * Frees the pool
+ */
+void actorFree(void) {
+    size_t i;
+
+    for (i = 0; i < NUM_COLUMNS; i++) {
+        free( * COLUMN(i));
+        * COLUMN(i) = NULL;
+    }
+
+    g_sActors.count = 0;
+    g_sActors.live = 0;
+    g_sActors.cap = 0;
+    g_sActors.freelist = -1;
+}
+
+/**
+ * Adds an actor with every field zeroed apart from its kind, returns
+ * ACTOR_NONE if out of memory
+ *
+ * Parameters:
+ * nKind		KIND_* of the actor
+ */
+ACTOR actorSpawn(int nKind) {
+    int i;
+    size_t c;
+    unsigned short nGen;
+
+    // Reuse a removed slot before growing
+    if (g_sActors.freelist >= 0) {
+        i = g_sActors.freelist;
+        g_sActors.freelist = g_sActors.nextfree[i];
+    } else {
+        if (actorReserve(g_sActors.count + 1) != 0)
+            return ACTOR_NONE;
+        i = g_sActors.count++;
+    }
+
+    // Clear the slot, but keep its generation
+    nGen = g_sActors.gen[i];
+    for (c = 0; c < NUM_COLUMNS; c++)
+        memset((char * ) * COLUMN(c) + i * s_aColumns[c].size, 0, s_aColumns[c].size);
+
+    if (nGen == 0)
+        nGen = 1;
+
+    g_sActors.gen[i] = nGen;
+    g_sActors.used[i] = 1;
+    g_sActors.kind[i] = nKind;
+    g_sActors.nextfree[i] = -1;
+    g_sActors.live++;
+
+    return actorHandle(i);
+}
+
+/**
+ * Removes an actor, its slot goes back on the free list
+ *
+ * Parameters:
+ * hActor		Actor to remove
+ */
+void actorRemove(ACTOR hActor) {
+    int i = actorIndex(hActor);
+
+    if (i < 0)
+        return;
+
+    g_sActors.used[i] = 0;
+    g_sActors.alive[i] = 0;
+    g_sActors.gen[i] = (g_sActors.gen[i] + 1) & ACTOR_GEN_MASK;
+    g_sActors.nextfree[i] = g_sActors.freelist;
+    g_sActors.freelist = i;
+    g_sActors.live--;
+}
+
+/**
+ * Returns the slot of an actor, or -1 if the handle is stale
+ *
+ * Parameters:
+ * hActor		Actor to look up
+ */
+int actorIndex(ACTOR hActor) {
+    int i = ACTOR_INDEX(hActor);
+
+    if (hActor == ACTOR_NONE || i >= g_sActors.count || !g_sActors.used[i] ||
+        g_sActors.gen[i] != hActor >> ACTOR_INDEX_BITS)
+        return -1;
+
+    return i;
+}
+
+/**
+ * Returns the handle of the actor in a slot
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+ACTOR actorHandle(int i) {
+    return ((ACTOR) g_sActors.gen[i] << ACTOR_INDEX_BITS) | i;
+}
+
+/**
+ * Packs the pool into a buffer: the used slots of every column, then the
+ * generations of the slots past them so handles stay stale after a
+ * restore. Returns the size of the packed pool, writing nothing if the
+ * buffer is NULL.
+ *
+ * Parameters:
+ * p			Buffer to pack into, or NULL to measure
+ */
+size_t actorPack(unsigned char * p) {
+    int aHead[4];
+    size_t nSize = sizeof(aHead);
+    size_t nBytes;
+    size_t c;
+    int nTail = g_sActors.cap - g_sActors.count;
+
+    for (c = 0; c < NUM_COLUMNS; c++)
+        nSize += g_sActors.count * s_aColumns[c].size;
+    nSize += nTail * sizeof(unsigned short);
+
+    if (p == NULL)
+        return nSize;
+
+    aHead[0] = g_sActors.count;
+    aHead[1] = g_sActors.live;
+    aHead[2] = g_sActors.cap;
+    aHead[3] = g_sActors.freelist;
+    memcpy(p, aHead, sizeof(aHead));
+    p += sizeof(aHead);
+
+    for (c = 0; c < NUM_COLUMNS; c++) {
+        nBytes = g_sActors.count * s_aColumns[c].size;
+        memcpy(p, * COLUMN(c), nBytes);
+        p += nBytes;
+    }
+
+    memcpy(p, g_sActors.gen + g_sActors.count, nTail * sizeof(unsigned short));
+
+    return nSize;
+}
+
+/**
+ * Replaces the pool with one packed by actorPack. Returns the number of
+ * bytes read, 0 if out of memory.
+ *
+ * Parameters:
+ * p			Packed pool
+ */
+size_t actorUnpack(const unsigned char * p) {
+    const unsigned char * pStart = p;
+    int aHead[4];
+    size_t nBytes;
+    size_t c;
+
+    memcpy(aHead, p, sizeof(aHead));
+    p += sizeof(aHead);
+
+    if (actorReserve(aHead[2]) != 0)
+        return 0;
+
+    g_sActors.count = aHead[0];
+    g_sActors.live = aHead[1];
+    g_sActors.freelist = aHead[3];
+
+    for (c = 0; c < NUM_COLUMNS; c++) {
+        nBytes = g_sActors.count * s_aColumns[c].size;
+        memcpy( * COLUMN(c), p, nBytes);
+        p += nBytes;
+    }
+
+    nBytes = (aHead[2] - g_sActors.count) * sizeof(unsigned short);
+    memcpy(g_sActors.gen + g_sActors.count, p, nBytes);
+    p += nBytes;
+
+    // Slots the packed pool never had start from scratch
+    memset(g_sActors.gen + aHead[2], 0, (g_sActors.cap - aHead[2]) * sizeof(unsigned short));
+
+    return p - pStart;
+}
+
+/**
+ * Lists the variables holding the actors of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int actorState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, g_sActors);
+
+    return n;
+}
@@ -0,0 +1,96 @@
+/**
+ * File:        actor.h
+ * Purpose:     Header file for actor.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _ACTOR_H_
+#define _ACTOR_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "state.h"
+
+// Actor kinds
+#define KIND_PLAYER 0
+#define KIND_PLANT 1
+#define NUM_KINDS 2
+
+// Handles keep the slot in the low bits and a generation above them
+#define ACTOR_INDEX_BITS 20
+#define ACTOR_INDEX_MASK ((1 << ACTOR_INDEX_BITS) - 1)
+#define ACTOR_INDEX(handle) ((int)((handle) & ACTOR_INDEX_MASK))
+
+// No actor, never handed out
+#define ACTOR_NONE 0
+
+// Stable reference to an actor, goes stale once the actor is removed
+typedef unsigned int ACTOR;
+
+// Actors stored column by column, slot i of every column is actor i
+typedef struct ACTORPOOL
+{
+	int count;
+	int live;
+	int cap;
+	int freelist;
+
+	// Position and movement, touched every tick
+	int * x;
+	int * y;
+	int * oldx;
+	int * oldy;
+	int * jump;
+	unsigned char * dir;
+	unsigned char * moving;
+	unsigned char * jumpqueued;
+
+	// State
+	unsigned char * used;
+	unsigned char * alive;
+	unsigned char * active;
+	unsigned char * kind;
+	short * w;
+	short * h;
+
+	// Ticks missed while far from every view, made up on the next turn
+	unsigned char * owed;
+
+	// Animation
+	unsigned char * frame;
+	unsigned char * maxframe;
+	unsigned char * framecount;
+	unsigned char * framedelay;
+
+	// Map column region the actor is listed in, kept by region.c
+	int * region;
+	int * rnext;
+	int * rprev;
+
+	// Bookkeeping for handles and free slots
+	unsigned short * gen;
+	int * nextfree;
+} ACTORPOOL;
+
+// Actors of the simulation
+extern SIM_LOCAL ACTORPOOL g_sActors;
+
+// Function declarations
+int actorReserve(int nCap);
+void actorClear(void);
+void actorFree(void);
+ACTOR actorSpawn(int nKind);
+void actorRemove(ACTOR hActor);
+int actorIndex(ACTOR hActor);
+ACTOR actorHandle(int i);
+size_t actorPack(unsigned char * p);
+size_t actorUnpack(const unsigned char * p);
+int actorState(STATEVAR * pVars);
+
+#endif
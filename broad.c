@@ -0,0 +1,276 @@
+/**
+ * File:        broad.c
+ * Purpose:     Uniform grid spatial hash broadphase for actor collisions
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "broad.h"
+
+// A box inserted this tick
+typedef struct BPPROXY
+{
+	int id;
+	int x, y, w, h;
+	int cx0, cy0, cx1, cy1;
+} BPPROXY;
+
+// A proxy's presence in one grid cell
+typedef struct BPENTRY
+{
+	int proxy;
+	int cx, cy;
+} BPENTRY;
+
+// Growable storage, reused from tick to tick
+static SIM_LOCAL BPPROXY * s_pProxies = NULL;
+static SIM_LOCAL int s_nProxies = 0;
+static SIM_LOCAL int s_nProxyCap = 0;
+
+static SIM_LOCAL BPENTRY * s_pEntries = NULL;
+static SIM_LOCAL BPENTRY * s_pSorted = NULL;
+static SIM_LOCAL int s_nEntries = 0;
+static SIM_LOCAL int s_nEntryCap = 0;
+static SIM_LOCAL int s_nSortedCap = 0;
+
+static SIM_LOCAL int * s_pBuckets = NULL;
+static SIM_LOCAL int s_nBucketCap = 0;
+
+static SIM_LOCAL BPPAIR * s_pPairs = NULL;
+static SIM_LOCAL int s_nPairCap = 0;
+
+/**
+ * Makes sure an array can hold at least the given number of elements
+ *
+ * Parameters:
+ * ppData		Array to grow
+ * pCap			Current capacity, updated on growth
+ * nNeeded		Number of elements needed
+ * nSize		Size of a single element
+ */
+static int reserve(void ** ppData, int * pCap, int nNeeded, size_t nSize) {
+    void * pNew;
+    int nCap;
+
+    if (nNeeded <= * pCap)
+        return 0;
+
+    nCap = * pCap ? * pCap : 64;
+    while (nCap < nNeeded)
+        nCap *= 2;
+
+    pNew = realloc( * ppData, nCap * nSize);
+    if (pNew == NULL)
+        return -1;
+
+    * ppData = pNew;
+    * pCap = nCap;
+    return 0;
+}
+
+/**
+ * Hashes a grid cell into a bucket
+ *
+ * Parameters:
+ * cx			Cell column
+ * cy			Cell row
+ * mask			Bucket count minus one
+ */
+static int hashCell(int cx, int cy, int mask) {
+    return (int)(((unsigned int) cx * 73856093u) ^ ((unsigned int) cy * 19349663u)) & mask;
+}
+
+/**
+ * Removes all boxes, call at the start of each tick
+ */
+void broadphaseClear(void) {
+    s_nProxies = 0;
+    s_nEntries = 0;
+}
+
+/**
+ * Inserts a box for this tick, returns -1 if out of memory
+ *
+ * Parameters:
+ * id			Caller's id for the box, usually the actor index
+ * x			X coordinate
+ * y			Y coordinate
+ * w			Width
+ * h			Height
+ */
+int broadphaseInsert(int id, int x, int y, int w, int h) {
+    BPPROXY * pProxy;
+    int cx, cy;
+
+    if (reserve((void ** ) & s_pProxies, & s_nProxyCap, s_nProxies + 1, sizeof(BPPROXY)))
+        return -1;
+
+    pProxy = & s_pProxies[s_nProxies];
+    pProxy -> id = id;
+    pProxy -> x = x;
+    pProxy -> y = y;
+    pProxy -> w = w;
+    pProxy -> h = h;
+    pProxy -> cx0 = x >> BROAD_CELL_SHIFT;
+    pProxy -> cy0 = y >> BROAD_CELL_SHIFT;
+    pProxy -> cx1 = (x + w - 1) >> BROAD_CELL_SHIFT;
+    pProxy -> cy1 = (y + h - 1) >> BROAD_CELL_SHIFT;
+
+    // One entry per covered cell, at most four for sprites up to a cell wide
+    for (cy = pProxy -> cy0; cy <= pProxy -> cy1; cy++) {
+        for (cx = pProxy -> cx0; cx <= pProxy -> cx1; cx++) {
+            if (reserve((void ** ) & s_pEntries, & s_nEntryCap, s_nEntries + 1, sizeof(BPENTRY)))
+                return -1;
+
+            s_pEntries[s_nEntries].proxy = s_nProxies;
+            s_pEntries[s_nEntries].cx = cx;
+            s_pEntries[s_nEntries].cy = cy;
+            s_nEntries++;
+        }
+    }
+
+    s_nProxies++;
+    return 0;
+}
+
+/**
+ * Finds all pairs of overlapping boxes inserted since the last clear,
+ * returns the number of pairs or -1 if out of memory
+ *
+ * Parameters:
+ * ppPairs		Receives the pair array, valid until the next call
+ */
+int broadphasePairs(BPPAIR ** ppPairs) {
+    int nBuckets;
+    int nPairs = 0;
+    int i, j, k, b;
+    BPENTRY * pA;
+    BPENTRY * pB;
+    BPPROXY * pPA;
+    BPPROXY * pPB;
+
+    * ppPairs = s_pPairs;
+    if (s_nEntries == 0)
+        return 0;
+
+    // Keep the table at least twice the entry count
+    nBuckets = 64;
+    while (nBuckets < s_nEntries * 2)
+        nBuckets *= 2;
+
+    if (reserve((void ** ) & s_pBuckets, & s_nBucketCap, nBuckets + 1, sizeof(int)))
+        return -1;
+    if (reserve((void ** ) & s_pSorted, & s_nSortedCap, s_nEntries, sizeof(BPENTRY)))
+        return -1;
+
+    // Counting sort of the entries by bucket
+    memset(s_pBuckets, 0, (nBuckets + 1) * sizeof(int));
+    for (i = 0; i < s_nEntries; i++)
+        s_pBuckets[hashCell(s_pEntries[i].cx, s_pEntries[i].cy, nBuckets - 1) + 1]++;
+    for (b = 0; b < nBuckets; b++)
+        s_pBuckets[b + 1] += s_pBuckets[b];
+    for (i = 0; i < s_nEntries; i++) {
+        b = hashCell(s_pEntries[i].cx, s_pEntries[i].cy, nBuckets - 1);
+        s_pSorted[s_pBuckets[b]++] = s_pEntries[i];
+    }
+
+    // Bucket b now ends at s_pBuckets[b], so walk the sorted run
+    for (i = 0; i < s_nEntries; i = k) {
+        b = hashCell(s_pSorted[i].cx, s_pSorted[i].cy, nBuckets - 1);
+        k = s_pBuckets[b];
+
+        for (; i < k; i++) {
+            pA = & s_pSorted[i];
+            pPA = & s_pProxies[pA -> proxy];
+
+            for (j = i + 1; j < k; j++) {
+                pB = & s_pSorted[j];
+
+                // Different cells sharing a bucket
+                if (pA -> cx != pB -> cx || pA -> cy != pB -> cy)
+                    continue;
+
+                pPB = & s_pProxies[pB -> proxy];
+
+                // Only report the pair from the first cell both boxes share
+                if (pA -> cx != (pPA -> cx0 > pPB -> cx0 ? pPA -> cx0 : pPB -> cx0) ||
+                    pA -> cy != (pPA -> cy0 > pPB -> cy0 ? pPA -> cy0 : pPB -> cy0))
+                    continue;
+
+                // Boxes must actually overlap
+                if (pPA -> x >= pPB -> x + pPB -> w || pPB -> x >= pPA -> x + pPA -> w ||
+                    pPA -> y >= pPB -> y + pPB -> h || pPB -> y >= pPA -> y + pPA -> h)
+                    continue;
+
+                if (reserve((void ** ) & s_pPairs, & s_nPairCap, nPairs + 1, sizeof(BPPAIR)))
+                    return -1;
+
+                // Lower id first, so callers can rely on the order
+                if (pPA -> id < pPB -> id) {
+                    s_pPairs[nPairs].a = pPA -> id;
+                    s_pPairs[nPairs].b = pPB -> id;
+                } else {
+                    s_pPairs[nPairs].a = pPB -> id;
+                    s_pPairs[nPairs].b = pPA -> id;
+                }
+                nPairs++;
+            }
+        }
+    }
+
+    * ppPairs = s_pPairs;
+    return nPairs;
+}
+
+/**
+ * Frees all broadphase storage
+ */
+void broadphaseFree(void) {
+    free(s_pProxies);
+    free(s_pEntries);
+    free(s_pSorted);
+    free(s_pBuckets);
+    free(s_pPairs);
+
+    s_pProxies = NULL;
+    s_pEntries = NULL;
+    s_pSorted = NULL;
+    s_pBuckets = NULL;
+    s_pPairs = NULL;
+
+    s_nProxies = s_nProxyCap = 0;
+    s_nEntries = s_nEntryCap = 0;
+    s_nSortedCap = 0;
+    s_nBucketCap = 0;
+    s_nPairCap = 0;
+}
+
+/**
+ * Lists the variables holding the broadphase of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int broadphaseState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, s_pProxies);
+    STATE_ADD(pVars, n, s_nProxies);
+    STATE_ADD(pVars, n, s_nProxyCap);
+    STATE_ADD(pVars, n, s_pEntries);
+    STATE_ADD(pVars, n, s_pSorted);
+    STATE_ADD(pVars, n, s_nEntries);
+    STATE_ADD(pVars, n, s_nEntryCap);
+    STATE_ADD(pVars, n, s_nSortedCap);
+    STATE_ADD(pVars, n, s_pBuckets);
+    STATE_ADD(pVars, n, s_nBucketCap);
+    STATE_ADD(pVars, n, s_pPairs);
+    STATE_ADD(pVars, n, s_nPairCap);
+
+    return n;
+}
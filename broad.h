@@ -0,0 +1,37 @@
+/**
+ * File:        broad.h
+ * Purpose:     Header file for broad.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _BROAD_H_
+#define _BROAD_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "state.h"
+
+// Size of a spatial hash cell in pixels, at least the largest sprite
+#define BROAD_CELL_SHIFT 6
+#define BROAD_CELL_SIZE (1 << BROAD_CELL_SHIFT)
+
+// Candidate pair of overlapping boxes, by the ids they were inserted with
+typedef struct BPPAIR
+{
+	int a, b;
+} BPPAIR;
+
+// Function declarations
+void broadphaseClear(void);
+int broadphaseInsert(int id, int x, int y, int w, int h);
+int broadphasePairs(BPPAIR ** ppPairs);
+void broadphaseFree(void);
+int broadphaseState(STATEVAR * pVars);
+
+#endif
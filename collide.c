@@ -0,0 +1,303 @@
+/**
+ * File:        collide.c
+ * Purpose:     Packed collision plane and grid raycasting
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <math.h>
+
+#include "collide.h"
+#include "level.h"
+
+// Collision plane, rebuilt after each map load
+unsigned int * g_pCollision = NULL;
+int g_nCollisionW = 0;
+int g_nCollisionH = 0;
+int g_nCollisionWords = 0;
+
+/**
+ * Sets or clears a single sub-tile bit in the collision plane
+ *
+ * Parameters:
+ * cx			Sub-tile column
+ * cy			Sub-tile row
+ * solid		Whether the sub-tile is solid
+ */
+static int setSubTile(int cx, int cy, int solid) {
+    unsigned int * pWord = g_pCollision + cy * g_nCollisionWords + (cx >> 5);
+    unsigned int nOld = * pWord;
+
+    if (solid)
+        * pWord |= 1u << (cx & 31);
+    else
+        * pWord &= ~(1u << (cx & 31));
+
+    return * pWord != nOld;
+}
+
+/**
+ * Tests a single sub-tile, anything outside the map is empty
+ *
+ * Parameters:
+ * cx			Sub-tile column
+ * cy			Sub-tile row
+ */
+int collisionSubTile(int cx, int cy) {
+    if (cx < 0 || cy < 0 || cx >= g_nCollisionW || cy >= g_nCollisionH)
+        return 0;
+
+    return (g_pCollision[cy * g_nCollisionWords + (cx >> 5)] >> (cx & 31)) & 1;
+}
+
+/**
+ * Builds the collision plane from the current level
+ */
+int collisionBuild(void) {
+    int tx, ty;
+
+    collisionFree();
+
+    g_nCollisionW = g_pLevel -> width * 2;
+    g_nCollisionH = g_pLevel -> height * 2;
+    g_nCollisionWords = (g_nCollisionW + 31) / 32;
+
+    g_pCollision = calloc(g_nCollisionWords * g_nCollisionH, sizeof(unsigned int));
+    if (g_pCollision == NULL)
+        return -1;
+
+    // Pack the four collision bits of each tile
+    for (ty = 0; ty < g_pLevel -> height; ty++)
+        for (tx = 0; tx < g_pLevel -> width; tx++)
+            collisionRefresh(tx, ty);
+
+    return 0;
+}
+
+/**
+ * Frees the collision plane
+ */
+void collisionFree(void) {
+    if (g_pCollision != NULL) {
+        free(g_pCollision);
+        g_pCollision = NULL;
+    }
+
+    g_nCollisionW = 0;
+    g_nCollisionH = 0;
+    g_nCollisionWords = 0;
+}
+
+/**
+ * Updates the collision plane for one tile, call after changing it,
+ * returns 1 if the solidity of the tile changed
+ *
+ * Parameters:
+ * tx			Tile column
+ * ty			Tile row
+ */
+int collisionRefresh(int tx, int ty) {
+    int nFlags;
+    int bChanged = 0;
+
+    if (g_pCollision == NULL || tx < 0 || ty < 0 || tx >= g_pLevel -> width || ty >= g_pLevel -> height)
+        return 0;
+
+    nFlags = levelGetBlock(tx, ty) -> flags;
+
+    bChanged |= setSubTile(tx * 2, ty * 2, nFlags & BLK_TL);
+    bChanged |= setSubTile(tx * 2 + 1, ty * 2, nFlags & BLK_TR);
+    bChanged |= setSubTile(tx * 2, ty * 2 + 1, nFlags & BLK_BL);
+    bChanged |= setSubTile(tx * 2 + 1, ty * 2 + 1, nFlags & BLK_BR);
+
+    return bChanged;
+}
+
+/**
+ * Checks whether the given map pixel is solid
+ *
+ * Parameters:
+ * x			X coordinate
+ * y			Y coordinate
+ */
+int collisionSolid(int x, int y) {
+    return collisionSubTile(x >> SUBTILE_SHIFT, y >> SUBTILE_SHIFT);
+}
+
+/**
+ * Checks whether any solid sub-tile overlaps the given box, testing each
+ * row of the plane a word at a time
+ *
+ * Parameters:
+ * x			X coordinate
+ * y			Y coordinate
+ * w			Width
+ * h			Height
+ */
+int collisionBox(int x, int y, int w, int h) {
+    int cx0 = x >> SUBTILE_SHIFT;
+    int cy0 = y >> SUBTILE_SHIFT;
+    int cx1 = (x + w - 1) >> SUBTILE_SHIFT;
+    int cy1 = (y + h - 1) >> SUBTILE_SHIFT;
+    int w0, w1, k;
+    unsigned int nMask0, nMask1;
+    unsigned int * pRow;
+
+    // Anything outside the map is empty
+    if (cx0 < 0)
+        cx0 = 0;
+    if (cy0 < 0)
+        cy0 = 0;
+    if (cx1 >= g_nCollisionW)
+        cx1 = g_nCollisionW - 1;
+    if (cy1 >= g_nCollisionH)
+        cy1 = g_nCollisionH - 1;
+    if (cx0 > cx1 || cy0 > cy1)
+        return 0;
+
+    // Column masks for the first and last word of each row
+    w0 = cx0 >> 5;
+    w1 = cx1 >> 5;
+    nMask0 = ~0u << (cx0 & 31);
+    nMask1 = ~0u >> (31 - (cx1 & 31));
+    if (w0 == w1)
+        nMask0 &= nMask1;
+
+    for (pRow = g_pCollision + cy0 * g_nCollisionWords; cy0 <= cy1; cy0++, pRow += g_nCollisionWords) {
+        if (pRow[w0] & nMask0)
+            return 1;
+
+        if (w0 != w1) {
+            for (k = w0 + 1; k < w1; k++)
+                if (pRow[k])
+                    return 1;
+
+            if (pRow[w1] & nMask1)
+                return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Walks the sub-tile grid along a line segment (DDA) and stops at the
+ * first solid sub-tile, returns 1 if one was hit. The sub-tiles walked
+ * are exactly those a point moving along the segment passes through, so
+ * crossings are kept as whole pixel distances rather than accumulated
+ * fractions.
+ *
+ * Parameters:
+ * x0			Starting X coordinate
+ * y0			Starting Y coordinate
+ * x1			Ending X coordinate
+ * y1			Ending Y coordinate
+ * pHit			Receives the hit details, may be NULL
+ */
+int raycast(int x0, int y0, int x1, int y1, RAYHIT * pHit) {
+    int dx = x1 - x0;
+    int dy = y1 - y0;
+    int adx = abs(dx);
+    int ady = abs(dy);
+    int cx = x0 >> SUBTILE_SHIFT;
+    int cy = y0 >> SUBTILE_SHIFT;
+    int stepx = dx > 0 ? 1 : -1;
+    int stepy = dy > 0 ? 1 : -1;
+    int nx, ny; // Pixels along each axis to the next boundary crossed
+    int bX, bY; // Whether the next boundary is crossed before the end
+    double fX, fY; // The crossings as times scaled by adx * ady
+    double t = 0.0;
+
+    // Moving up or left, a point on a boundary still belongs to the
+    // sub-tile it is in, and only leaves it right after
+    nx = dx > 0 ? ((cx + 1) << SUBTILE_SHIFT) - x0 : x0 - (cx << SUBTILE_SHIFT);
+    ny = dy > 0 ? ((cy + 1) << SUBTILE_SHIFT) - y0 : y0 - (cy << SUBTILE_SHIFT);
+
+    for (;;) {
+        if (collisionSubTile(cx, cy)) {
+            if (pHit != NULL) {
+                pHit -> hit = 1;
+                pHit -> cx = cx;
+                pHit -> cy = cy;
+                pHit -> x = x0 + (int)(dx * t);
+                pHit -> y = y0 + (int)(dy * t);
+                pHit -> dist = (int)(t * sqrt((double) dx * dx + (double) dy * dy));
+            }
+            return 1;
+        }
+
+        // Stop at the end of the segment
+        bX = dx > 0 ? nx <= adx : dx < 0 && nx < adx;
+        bY = dy > 0 ? ny <= ady : dy < 0 && ny < ady;
+        if (!bX && !bY)
+            break;
+
+        // The nearer boundary first. Through a corner, a move right or
+        // down happens at the crossing and one left or up right after it,
+        // so only a mixed pair passes through a side sub-tile.
+        if (bX && bY) {
+            fX = (double) nx * ady;
+            fY = (double) ny * adx;
+            if (fX < fY || (fX == fY && dx > 0 && dy < 0))
+                bY = 0;
+            else if (fY < fX || (fX == fY && dx < 0 && dy > 0))
+                bX = 0;
+        }
+
+        if (bX) {
+            t = (double) nx / adx;
+            nx += SUBTILE_SIZE;
+            cx += stepx;
+        }
+        if (bY) {
+            t = (double) ny / ady;
+            ny += SUBTILE_SIZE;
+            cy += stepy;
+        }
+    }
+
+    if (pHit != NULL) {
+        pHit -> hit = 0;
+        pHit -> cx = x1 >> SUBTILE_SHIFT;
+        pHit -> cy = y1 >> SUBTILE_SHIFT;
+        pHit -> x = x1;
+        pHit -> y = y1;
+        pHit -> dist = (int) sqrt((double) dx * dx + (double) dy * dy);
+    }
+
+    return 0;
+}
+
+/**
+ * Casts a batch of rays, returns the number of rays that hit something
+ *
+ * Parameters:
+ * pRays		Rays to cast
+ * pHits		Receives one result per ray
+ * nCount		Number of rays
+ */
+int raycastBatch(const RAY * pRays, RAYHIT * pHits, int nCount) {
+    int i;
+    int nHits = 0;
+
+    for (i = 0; i < nCount; i++)
+        nHits += raycast(pRays[i].x0, pRays[i].y0, pRays[i].x1, pRays[i].y1, & pHits[i]);
+
+    return nHits;
+}
+
+/**
+ * Checks whether there is a clear line of sight between two points
+ *
+ * Parameters:
+ * x0			Starting X coordinate
+ * y0			Starting Y coordinate
+ * x1			Ending X coordinate
+ * y1			Ending Y coordinate
+ */
+int lineOfSight(int x0, int y0, int x1, int y1) {
+    return !raycast(x0, y0, x1, y1, NULL);
+}
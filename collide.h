@@ -0,0 +1,55 @@
+/**
+ * File:        collide.h
+ * Purpose:     Header file for collide.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _COLLIDE_H_
+#define _COLLIDE_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Each map tile is split into 2x2 collision sub-tiles of 16x16 pixels
+#define SUBTILE_SHIFT 4
+#define SUBTILE_SIZE (1 << SUBTILE_SHIFT)
+
+// A single ray, from (x0, y0) to (x1, y1) in map pixels
+typedef struct RAY
+{
+	int x0, y0;
+	int x1, y1;
+} RAY;
+
+// Result of a ray query
+typedef struct RAYHIT
+{
+	int hit;
+	int cx, cy;
+	int x, y;
+	int dist;
+} RAYHIT;
+
+// Packed collision plane, one bit per sub-tile, rows of 32-bit words
+extern unsigned int * g_pCollision;
+extern int g_nCollisionW;
+extern int g_nCollisionH;
+extern int g_nCollisionWords;
+
+// Function declarations
+int collisionBuild(void);
+void collisionFree(void);
+int collisionRefresh(int tx, int ty);
+int collisionSubTile(int cx, int cy);
+int collisionSolid(int x, int y);
+int collisionBox(int x, int y, int w, int h);
+int raycast(int x0, int y0, int x1, int y1, RAYHIT * pHit);
+int raycastBatch(const RAY * pRays, RAYHIT * pHits, int nCount);
+int lineOfSight(int x0, int y0, int x1, int y1);
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * File:        env.c
+ * Purpose:     Steps many games on one map side by side, for agents
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "env.h"
+
+// Runs of games handed out per worker thread, so threads that finish
+// early can pick up more
+#define ENV_PARTS_PER_THREAD 4
+
+/**
+ * Returns where a game's state is kept, the caller's own is kept ahead
+ * of the games
+ *
+ * Parameters:
+ * pEnv			Environment
+ * i			Game, or -1 for the caller's own
+ */
+static unsigned char * envState(ENV * pEnv, int i) {
+    return pEnv -> states + (i + 1) * pEnv -> statesize;
+}
+
+/**
+ * Swaps a game into the state variables of the calling thread
+ *
+ * Parameters:
+ * pEnv			Environment
+ * i			Game, or -1 for the caller's own
+ */
+static void envLoad(ENV * pEnv, int i) {
+    STATEVAR aVars[STATE_MAX_VARS];
+    unsigned char * p = envState(pEnv, i);
+    int n, v;
+
+    n = simState(aVars);
+    for (v = 0; v < n; v++) {
+        memcpy(aVars[v].addr, p, aVars[v].size);
+        p += aVars[v].size;
+    }
+}
+
+/**
+ * Keeps the state variables of the calling thread as a game
+ *
+ * Parameters:
+ * pEnv			Environment
+ * i			Game, or -1 for the caller's own
+ */
+static void envSave(ENV * pEnv, int i) {
+    STATEVAR aVars[STATE_MAX_VARS];
+    unsigned char * p = envState(pEnv, i);
+    int n, v;
+
+    n = simState(aVars);
+    for (v = 0; v < n; v++) {
+        memcpy(p, aVars[v].addr, aVars[v].size);
+        p += aVars[v].size;
+    }
+}
+
+/**
+ * Describes the game in the state variables of the calling thread
+ *
+ * Parameters:
+ * pObs			Receives the description
+ */
+static void envLook(ENVOBS * pObs) {
+    pObs -> x = g_sActors.x[PLAYER];
+    pObs -> y = g_sActors.y[PLAYER];
+    pObs -> alive = g_sActors.alive[PLAYER];
+    pObs -> victory = g_bVictory;
+    pObs -> score = g_nPlayerScore;
+    pObs -> timeleft = g_nTimeLeft;
+    pObs -> checksum = simChecksum();
+}
+
+/**
+ * Steps one run of games, on whichever thread picked it up
+ *
+ * Parameters:
+ * pData		Environment
+ * nPart		Run of games
+ */
+static void envPart(void * pData, int nPart) {
+    ENV * pEnv = pData;
+    int nParts = workerCount() * ENV_PARTS_PER_THREAD;
+    int nFirst, nLast;
+    int i;
+
+    if (nParts > pEnv -> count)
+        nParts = pEnv -> count;
+
+    nFirst = (int)((long) pEnv -> count * nPart / nParts);
+    nLast = (int)((long) pEnv -> count * (nPart + 1) / nParts);
+
+    for (i = nFirst; i < nLast; i++) {
+        envLoad(pEnv, i);
+
+        simTick(pEnv -> inputs[i]);
+
+        // Nobody draws these games
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+
+        if (pEnv -> obs != NULL)
+            envLook( & pEnv -> obs[i]);
+
+        envSave(pEnv, i);
+    }
+}
+
+/**
+ * Loads a map and starts a number of games on it, stepped by a pool of
+ * threads. The blocks, pristine cells, collision plane and platform graph
+ * of the map are shared; each game has its own cells, actors, score and
+ * time. Only one environment can exist at a time, and the calling thread
+ * must not be playing a game of its own. Returns NULL on failure.
+ *
+ * Parameters:
+ * szMap		Path to the map file
+ * nCount		Number of games
+ * nThreads		Threads to step them on, the calling thread included
+ */
+ENV * envCreate(const char * szMap, int nCount, int nThreads) {
+    STATEVAR aVars[STATE_MAX_VARS];
+    ENV * pEnv;
+    LEVEL * pLevel;
+    int v, i;
+
+    // Every variable of a game has to fit in the lists below
+    if (nCount < 1 || simState(NULL) > STATE_MAX_VARS)
+        return NULL;
+
+    pEnv = calloc(1, sizeof(ENV));
+    if (pEnv == NULL)
+        return NULL;
+
+    pEnv -> level = levelLoad(szMap);
+    if (pEnv -> level == NULL) {
+        free(pEnv);
+        return NULL;
+    }
+
+    // Derived data of the map, shared by every game
+    g_pLevel = pEnv -> level;
+    collisionBuild();
+    navBuild();
+    g_pLevel = NULL;
+
+    pEnv -> nvars = simState(aVars);
+    for (v = 0; v < pEnv -> nvars; v++)
+        pEnv -> statesize += aVars[v].size;
+
+    pEnv -> states = calloc(nCount + 1, pEnv -> statesize);
+    if (pEnv -> states == NULL) {
+        envFree(pEnv);
+        return NULL;
+    }
+
+    // Every game starts from the caller's state, before any game was played
+    envSave(pEnv, -1);
+
+    for (i = 0; i < nCount; i++) {
+        envLoad(pEnv, -1);
+
+        pLevel = levelShare(pEnv -> level);
+        if (pLevel == NULL || simStart(pLevel) != 0) {
+            if (pLevel != NULL)
+                simStop();
+            envLoad(pEnv, -1);
+            envFree(pEnv);
+            return NULL;
+        }
+
+        envSave(pEnv, i);
+        pEnv -> count++;
+    }
+
+    envLoad(pEnv, -1);
+
+    workerStart(nThreads);
+
+    return pEnv;
+}
+
+/**
+ * Ends every game and frees the map
+ *
+ * Parameters:
+ * pEnv			Environment to free
+ */
+void envFree(ENV * pEnv) {
+    int i;
+
+    if (pEnv == NULL)
+        return;
+
+    workerStop();
+
+    for (i = 0; i < pEnv -> count; i++) {
+        envLoad(pEnv, i);
+        simStop();
+    }
+    if (pEnv -> states != NULL)
+        envLoad(pEnv, -1);
+
+    navFree();
+    collisionFree();
+    levelFree(pEnv -> level);
+
+    free(pEnv -> states);
+    free(pEnv);
+}
+
+/**
+ * Steps every game by one tick, all on the same tick. The result of each
+ * game does not depend on the number of threads.
+ *
+ * Parameters:
+ * pEnv			Environment
+ * pInputs		INPUT_* buttons for each game
+ * pObs			Receives what each game looks like afterwards, or NULL
+ */
+void envStep(ENV * pEnv, const int * pInputs, ENVOBS * pObs) {
+    int nParts = workerCount() * ENV_PARTS_PER_THREAD;
+
+    if (nParts > pEnv -> count)
+        nParts = pEnv -> count;
+
+    pEnv -> inputs = pInputs;
+    pEnv -> obs = pObs;
+
+    workerRun(envPart, pEnv, nParts);
+
+    // The caller's own state is whatever game it stepped last
+    envLoad(pEnv, -1);
+}
+
+/**
+ * Describes every game without stepping it
+ *
+ * Parameters:
+ * pEnv			Environment
+ * pObs			Receives what each game looks like
+ */
+void envObserve(ENV * pEnv, ENVOBS * pObs) {
+    int i;
+
+    for (i = 0; i < pEnv -> count; i++) {
+        envLoad(pEnv, i);
+        envLook( & pObs[i]);
+    }
+
+    envLoad(pEnv, -1);
+}
@@ -0,0 +1,49 @@
+/**
+ * File:        env.h
+ * Purpose:     Header file for env.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _ENV_H_
+#define _ENV_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "sim.h"
+
+// What an agent sees of its game after a step
+typedef struct ENVOBS
+{
+	int x, y;
+	int alive;
+	int victory;
+	int score;
+	int timeleft;
+	unsigned int checksum;
+} ENVOBS;
+
+// Games played side by side on one map
+typedef struct ENV
+{
+	int count;
+	int nvars;
+	size_t statesize;
+	LEVEL * level;
+	unsigned char * states;
+	const int * inputs;
+	ENVOBS * obs;
+} ENV;
+
+// Function declarations
+ENV * envCreate(const char * szMap, int nCount, int nThreads);
+void envFree(ENV * pEnv);
+void envStep(ENV * pEnv, const int * pInputs, ENVOBS * pObs);
+void envObserve(ENV * pEnv, ENVOBS * pObs);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * File:        envrun.c
+ * Purpose:     Plays many games side by side with scripted players and
+ *              reports the throughput
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "env.h"
+#include "pace.h"
+
+// Defaults when no arguments are given
+#define DEFAULT_GAMES 64
+#define DEFAULT_STEPS 10000
+
+/**
+ * Decides on input for the scripted player of a game: run right, jump
+ * when stuck or every so often, each game at its own rhythm, and restart
+ * as soon as the game is over
+ *
+ * Parameters:
+ * pObs			The game after the last step
+ * nOldX		Player X coordinate the step before
+ * nGame		Game number
+ * nStep		Current step
+ */
+static int botInput(const ENVOBS * pObs, int nOldX, int nGame, long nStep) {
+    int nInput = INPUT_RIGHT;
+
+    if (!pObs -> alive)
+        return nInput | INPUT_RESTART;
+
+    if (pObs -> x == nOldX || nStep % (30 + nGame % 31) == 0)
+        nInput |= INPUT_JUMP;
+
+    return nInput;
+}
+
+/**
+ * Entry point for the environment driver
+ *
+ * Usage: envrun [-threads n] [map file] [games] [steps]
+ */
+int main(int argc, char * argv[]) {
+    const char * szMap = "map.fmp";
+    int nThreads = 1;
+    int nGames = DEFAULT_GAMES;
+    long nSteps = DEFAULT_STEPS;
+    long nStep;
+    int nArg = 1;
+    int i;
+    ENV * pEnv;
+    ENVOBS * pObs;
+    int * pInputs;
+    int * pOldX;
+    long nFinished = 0; // Games finished
+    long nWins = 0; // Games won
+    long nBest = 0; // Best score
+    unsigned int nSum = 0; // Final checksums of every game together
+    double dStart;
+    double dSeconds;
+
+    // Options first, then the positional arguments
+    for (; nArg + 1 < argc && argv[nArg][0] == '-'; nArg += 2) {
+        if (!strcmp(argv[nArg], "-threads"))
+            nThreads = atoi(argv[nArg + 1]);
+    }
+
+    if (nArg < argc)
+        szMap = argv[nArg++];
+    if (nArg < argc)
+        nGames = atoi(argv[nArg++]);
+    if (nArg < argc)
+        nSteps = atol(argv[nArg]);
+
+    pEnv = envCreate(szMap, nGames, nThreads);
+    if (pEnv == NULL) {
+        fprintf(stderr, "Error starting %d games on %s\n", nGames, szMap);
+        return 1;
+    }
+
+    pObs = malloc(nGames * sizeof(ENVOBS));
+    pInputs = malloc(nGames * sizeof(int));
+    pOldX = malloc(nGames * sizeof(int));
+    if (pObs == NULL || pInputs == NULL || pOldX == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    envObserve(pEnv, pObs);
+    for (i = 0; i < nGames; i++)
+        pOldX[i] = -1;
+
+    printf("%d games on %d threads\n", nGames, workerCount());
+
+    // Wall clock time, the CPU time of every thread would add up
+    dStart = paceNow();
+
+    for (nStep = 0; nStep < nSteps; nStep++) {
+        for (i = 0; i < nGames; i++) {
+            // Game is over and the bot restarts this step, record it first
+            if (!pObs[i].alive) {
+                nFinished++;
+                nWins += pObs[i].victory;
+                if (pObs[i].score > nBest)
+                    nBest = pObs[i].score;
+            }
+
+            pInputs[i] = botInput( & pObs[i], pOldX[i], i, nStep);
+            pOldX[i] = pObs[i].x;
+        }
+
+        envStep(pEnv, pInputs, pObs);
+    }
+
+    dSeconds = (paceNow() - dStart) / 1e6;
+
+    for (i = 0; i < nGames; i++)
+        nSum = nSum * 31u + pObs[i].checksum;
+
+    printf("%ld steps of %d games in %.3f s", nSteps, nGames, dSeconds);
+    if (dSeconds > 0)
+        printf(", %.0f steps/s", nSteps * nGames / dSeconds);
+    printf("\n%ld games finished, %ld won, best score %ld, checksum %08x\n", nFinished, nWins, nBest, nSum);
+
+    free(pObs);
+    free(pInputs);
+    free(pOldX);
+    envFree(pEnv);
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * File:        event.c
+ * Purpose:     Queues what happened during a tick, for sound, the display
+ *              and statistics to pick up afterwards
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include "event.h"
+
+// Events of the last tick
+SIM_LOCAL EVENTQUEUE g_sEvents = { 0, 0 };
+
+/**
+ * Empties a queue
+ *
+ * Parameters:
+ * pQueue		Queue to empty
+ */
+void eventClear(EVENTQUEUE * pQueue) {
+    pQueue -> count = 0;
+    pQueue -> dropped = 0;
+}
+
+/**
+ * Adds an event to a queue. Each queue belongs to one thread at a time,
+ * so there is no locking.
+ *
+ * Parameters:
+ * pQueue		Queue to add to
+ * nType		EVENT_* type
+ * nActor		Slot of the actor it happened to
+ * x			X coordinate it happened at
+ * y			Y coordinate it happened at
+ * nValue		Points gained, for gems and victory
+ */
+void eventPush(EVENTQUEUE * pQueue, int nType, int nActor, int x, int y, int nValue) {
+    EVENT * pEvent;
+
+    if (pQueue -> count == EVENT_MAX) {
+        pQueue -> dropped++;
+        return;
+    }
+
+    pEvent = & pQueue -> events[pQueue -> count++];
+    pEvent -> type = nType;
+    pEvent -> actor = nActor;
+    pEvent -> x = x;
+    pEvent -> y = y;
+    pEvent -> value = nValue;
+}
+
+/**
+ * Adds the events of one queue after those of another
+ *
+ * Parameters:
+ * pQueue		Queue to add to
+ * pFrom		Queue to add
+ */
+void eventAppend(EVENTQUEUE * pQueue, const EVENTQUEUE * pFrom) {
+    int i;
+
+    for (i = 0; i < pFrom -> count; i++)
+        eventPush(pQueue, pFrom -> events[i].type, pFrom -> events[i].actor,
+            pFrom -> events[i].x, pFrom -> events[i].y, pFrom -> events[i].value);
+
+    pQueue -> dropped += pFrom -> dropped;
+}
+
+/**
+ * Lists the variables holding the events of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int eventState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, g_sEvents);
+
+    return n;
+}
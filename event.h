@@ -0,0 +1,56 @@
+/**
+ * File:        event.h
+ * Purpose:     Header file for event.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _EVENT_H_
+#define _EVENT_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "state.h"
+
+// Things that happened during a tick
+#define EVENT_JUMP 1 // The player took off
+#define EVENT_DEATH 2 // The player was killed
+#define EVENT_GEM 3 // The player took a gem, value is the points
+#define EVENT_VICTORY 4 // The player reached the goal, value is the points
+#define EVENT_TIMEUP 5 // The time limit ran out and the player with it
+
+// Most events kept for one tick, any more are counted and dropped
+#define EVENT_MAX 32
+
+// One thing that happened, where and to which actor
+typedef struct EVENT
+{
+	int type;
+	int actor;
+	int x, y;
+	int value;
+} EVENT;
+
+// Events in the order they happened
+typedef struct EVENTQUEUE
+{
+	int count;
+	int dropped;
+	EVENT events[EVENT_MAX];
+} EVENTQUEUE;
+
+// Events of the last tick, for whoever wants them once it is done
+extern SIM_LOCAL EVENTQUEUE g_sEvents;
+
+// Function declarations
+void eventClear(EVENTQUEUE * pQueue);
+void eventPush(EVENTQUEUE * pQueue, int nType, int nActor, int x, int y, int nValue);
+void eventAppend(EVENTQUEUE * pQueue, const EVENTQUEUE * pFrom);
+int eventState(STATEVAR * pVars);
+
+#endif
@@ -0,0 +1,1250 @@
+/**
+ * File:        headless.c
+ * Purpose:     Runs the simulation without a display, as fast as it goes
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "sim.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "rewind.h"
+#include "pace.h"
+
+// Ticks to run when none are given
+#define DEFAULT_TICKS 1000000
+
+// Snapshot check: ticks between snapshots, and ticks played from each
+#define SNAP_EVERY 500
+#define SNAP_BRANCH 120
+
+// Saves and loads timed for each snapshot
+#define SNAP_TIMING 200
+
+// Rewind check: bytes to keep ticks in, ticks between checks, seeks at
+// each check, and ticks gone back and played again after them
+#define REWIND_BUDGET (4 << 20)
+#define REWIND_CHECK_EVERY 1000
+#define REWIND_SEEKS 100
+#define REWIND_REPLAY 90
+
+// Ray check: rays cast, cast together in batches of, and furthest each
+// end can be from the start, in pixels
+#define RAY_CHECKS 20000
+#define RAY_BATCH 64
+#define RAY_REACH 400
+
+// Route check: routes asked for, and frames given to each before it
+// counts as lost
+#define PATH_CHECKS 2048
+#define PATH_FRAMES 1000
+
+// Platform graph check: rounds of edits, most tiles changed in a round,
+// and how far from each other, in tiles
+#define NAV_ROUNDS 300
+#define NAV_EDITS 8
+#define NAV_SPREAD 6
+
+// Crowd: plants start this far right of the player, in pixels, and stand
+// in rows this far apart
+#define CROWD_FIRST VIEW_W
+#define CROWD_ROW 150
+
+// Thread counts the parallel check plays the same ticks on
+static const int s_aParallel[] = { 1, 2, 4 };
+
+// Fields of an actor the detail check compares
+#define DETAIL_FIELDS 7
+
+/**
+ * Returns the next number of a repeatable pseudo-random sequence
+ *
+ * Parameters:
+ * pSeed		State of the sequence
+ */
+static unsigned int nextRandom(unsigned int * pSeed) {
+    * pSeed = * pSeed * 1103515245u + 12345u;
+    return * pSeed >> 8;
+}
+
+/**
+ * Decides on input for a scripted player: run right, jump when stuck or
+ * every so often, and restart as soon as the game is over
+ *
+ * Parameters:
+ * nTick		Current tick
+ */
+static int botInput(long nTick) {
+    int nInput = INPUT_RIGHT;
+
+    if (!g_sActors.alive[PLAYER])
+        return nInput | INPUT_RESTART;
+
+    if (g_sActors.x[PLAYER] == g_sActors.oldx[PLAYER] || nTick % 45 == 0)
+        nInput |= INPUT_JUMP;
+
+    return nInput;
+}
+
+/**
+ * Plays a replay and reports whether it still matches the simulation
+ *
+ * Parameters:
+ * szPath		Path to the replay file
+ */
+static int playReplay(const char * szPath) {
+    REPLAY * pReplay;
+    long nFailed;
+    double dStart;
+    double dSeconds;
+
+    pReplay = replayLoad(szPath);
+    if (pReplay == NULL) {
+        fprintf(stderr, "Error loading replay %s\n", szPath);
+        return 1;
+    }
+
+    // Wall clock time, the CPU time of every thread would add up
+    dStart = paceNow();
+    nFailed = replayRun(pReplay);
+    dSeconds = (paceNow() - dStart) / 1e6;
+
+    if (nFailed >= 0) {
+        printf("Replay differs at tick %ld of %ld\n", nFailed, pReplay -> nticks);
+    } else {
+        printf("%ld ticks replayed in %.3f s", pReplay -> nticks, dSeconds);
+        if (dSeconds > 0)
+            printf(", %.0f ticks/s", pReplay -> nticks / dSeconds);
+        printf("\n");
+    }
+
+    replayFree(pReplay);
+
+    return nFailed >= 0;
+}
+
+/**
+ * Plays with the scripted player, taking snapshots along the way. From
+ * each one the game is played on, put back and played again, which has to
+ * give the same ticks. Reports the size of the snapshots and how long
+ * saving and loading them takes. Returns nonzero if any branch differed.
+ *
+ * Parameters:
+ * nTicks		Ticks to play
+ */
+static int checkSnapshots(long nTicks) {
+    unsigned char * pSnap;
+    unsigned int aSums[SNAP_BRANCH];
+    size_t nSize, nFull;
+    size_t nMost = 0;
+    long nTick, nBranch;
+    long nSnaps = 0;
+    long nFailed = 0;
+    clock_t tSave = 0, tLoad = 0, tStart;
+    int i;
+
+    nFull = snapSave(NULL, 0, 0);
+
+    for (nTick = 0; nTick < nTicks; nTick++) {
+        if (nTick % SNAP_EVERY == 0) {
+            nSize = snapSave(NULL, 0, SNAP_DELTA);
+            pSnap = malloc(nSize);
+            if (pSnap == NULL)
+                return 1;
+            if (nSize > nMost)
+                nMost = nSize;
+
+            tStart = clock();
+            for (i = 0; i < SNAP_TIMING; i++)
+                snapSave(pSnap, nSize, SNAP_DELTA);
+            tSave += clock() - tStart;
+
+            // One way
+            for (nBranch = 0; nBranch < SNAP_BRANCH; nBranch++) {
+                simTick(botInput(nTick + nBranch));
+                aSums[nBranch] = simChecksum();
+            }
+
+            // And again
+            tStart = clock();
+            for (i = 0; i < SNAP_TIMING; i++)
+                snapLoad(pSnap, nSize);
+            tLoad += clock() - tStart;
+
+            for (nBranch = 0; nBranch < SNAP_BRANCH; nBranch++) {
+                simTick(botInput(nTick + nBranch));
+                if (simChecksum() != aSums[nBranch]) {
+                    nFailed++;
+                    break;
+                }
+            }
+
+            snapLoad(pSnap, nSize);
+            free(pSnap);
+            nSnaps++;
+        }
+
+        simTick(botInput(nTick));
+
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+    }
+
+    printf("%ld snapshots, %ld branches differed\n", nSnaps, nFailed);
+    printf("full snapshot %lu bytes, delta at most %lu bytes\n", (unsigned long) nFull, (unsigned long) nMost);
+    if (nSnaps > 0)
+        printf("save %.2f us, load %.2f us\n",
+            (double) tSave * 1e6 / CLOCKS_PER_SEC / (nSnaps * SNAP_TIMING),
+            (double) tLoad * 1e6 / CLOCKS_PER_SEC / (nSnaps * SNAP_TIMING));
+
+    return nFailed != 0;
+}
+
+/**
+ * Plays with the scripted player, keeping every tick in a rewind buffer.
+ * Every so often it seeks to ticks held, which have to match the game as
+ * it was, then goes back a little and plays on again from there. Reports
+ * how many ticks the buffer holds and how long pushing and seeking take.
+ * Returns nonzero if any tick differed.
+ *
+ * Parameters:
+ * nTicks		Ticks to play
+ */
+static int checkRewind(long nTicks) {
+    REWIND * pRewind;
+    unsigned int * pSums;
+    unsigned int nSeed = 1;
+    long nTick, nSeek, nHeld;
+    long nSeeks = 0;
+    long nFailed = 0;
+    clock_t tPush = 0, tSeek = 0, tWorst = 0, tStart, tTaken;
+    int i;
+
+    pRewind = rewindCreate(REWIND_BUDGET, REWIND_KEY_EVERY);
+    pSums = malloc((nTicks + 1) * sizeof(unsigned int));
+    if (pRewind == NULL || pSums == NULL) {
+        rewindFree(pRewind);
+        free(pSums);
+        return 1;
+    }
+
+    pSums[0] = simChecksum();
+    rewindPush(pRewind, 0);
+
+    for (nTick = 1; nTick <= nTicks; nTick++) {
+        simTick(botInput(nTick - 1));
+        pSums[nTick] = simChecksum();
+
+        tStart = clock();
+        rewindPush(pRewind, nTick);
+        tPush += clock() - tStart;
+
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+
+        if (nTick % REWIND_CHECK_EVERY != 0)
+            continue;
+
+        // Anywhere held
+        nHeld = rewindNewest(pRewind) - rewindOldest(pRewind) + 1;
+        for (i = 0; i < REWIND_SEEKS; i++) {
+            nSeed = nSeed * 1103515245u + 12345u;
+            nSeek = rewindOldest(pRewind) + (long)((nSeed >> 8) % (unsigned long) nHeld);
+
+            tStart = clock();
+            if (rewindSeek(pRewind, nSeek) != 0 || simChecksum() != pSums[nSeek])
+                nFailed++;
+            tTaken = clock() - tStart;
+
+            tSeek += tTaken;
+            if (tTaken > tWorst)
+                tWorst = tTaken;
+            nSeeks++;
+        }
+
+        // Back a little, and the same ticks again
+        nSeek = nTick - REWIND_REPLAY > rewindOldest(pRewind) ? nTick - REWIND_REPLAY : rewindOldest(pRewind);
+        if (rewindSeek(pRewind, nSeek) != 0)
+            nFailed++;
+        for (nSeek++; nSeek <= nTick; nSeek++) {
+            simTick(botInput(nSeek - 1));
+            rewindPush(pRewind, nSeek);
+            if (simChecksum() != pSums[nSeek]) {
+                nFailed++;
+                break;
+            }
+        }
+
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+    }
+
+    printf("%ld seeks, %ld differed\n", nSeeks, nFailed);
+    printf("%ld ticks held in %lu of %lu bytes, %lu bytes in all\n",
+        rewindNewest(pRewind) - rewindOldest(pRewind) + 1, (unsigned long) rewindUsed(pRewind),
+        (unsigned long) pRewind -> budget, (unsigned long) rewindMemory(pRewind));
+    if (pRewind -> keys > 0 && pRewind -> deltas > 0)
+        printf("snapshot %lu bytes, keyframe %.0f bytes, delta %.0f bytes on average\n",
+            (unsigned long) pRewind -> lastsize, pRewind -> keybytes / pRewind -> keys,
+            pRewind -> deltabytes / pRewind -> deltas);
+    if (nSeeks > 0)
+        printf("push %.2f us, seek %.2f us on average, %.2f us at most\n",
+            (double) tPush * 1e6 / CLOCKS_PER_SEC / nTicks,
+            (double) tSeek * 1e6 / CLOCKS_PER_SEC / nSeeks,
+            (double) tWorst * 1e6 / CLOCKS_PER_SEC);
+
+    rewindFree(pRewind);
+    free(pSums);
+
+    return nFailed != 0;
+}
+
+/**
+ * Narrows the times a point moving along one axis of a segment spends in
+ * a span of one sub-tile. Bounds are times from 0 to 1, with flags for
+ * whether the bound itself is left out.
+ *
+ * Parameters:
+ * p0			Start of the segment on this axis
+ * d			Distance moved along this axis
+ * a			Start of the span
+ * pLow			Lower bound, narrowed
+ * pLowOpen		Whether the lower bound is left out
+ * pHigh		Upper bound, narrowed
+ * pHighOpen	Whether the upper bound is left out
+ */
+static void spanTimes(int p0, int d, int a, double * pLow, int * pLowOpen, double * pHigh, int * pHighOpen) {
+    double dLow, dHigh;
+    int bLowOpen, bHighOpen;
+
+    if (d == 0) {
+        // Never there, or always
+        if (p0 < a || p0 >= a + SUBTILE_SIZE) {
+            * pLow = 2.0;
+            * pHigh = -1.0;
+        }
+        return;
+    }
+
+    // The span includes its start and not its end
+    if (d > 0) {
+        dLow = (double)(a - p0) / d;
+        dHigh = (double)(a + SUBTILE_SIZE - p0) / d;
+        bLowOpen = 0;
+        bHighOpen = 1;
+    } else {
+        dLow = (double)(p0 - a - SUBTILE_SIZE) / -d;
+        dHigh = (double)(p0 - a) / -d;
+        bLowOpen = 1;
+        bHighOpen = 0;
+    }
+
+    if (dLow > * pLow || (dLow == * pLow && bLowOpen)) {
+        * pLowOpen = dLow > * pLow ? bLowOpen : 1;
+        * pLow = dLow;
+    }
+    if (dHigh < * pHigh || (dHigh == * pHigh && bHighOpen)) {
+        * pHighOpen = dHigh < * pHigh ? bHighOpen : 1;
+        * pHigh = dHigh;
+    }
+}
+
+/**
+ * Finds the first solid sub-tile along a segment the slow way: works out
+ * when a point moving along it enters every sub-tile of its bounding box
+ * and takes the earliest solid one. Returns 1 if there is one.
+ *
+ * Parameters:
+ * pRay			Segment to look along
+ * pCX			Receives the column of the sub-tile
+ * pCY			Receives the row of the sub-tile
+ */
+static int firstSolid(const RAY * pRay, int * pCX, int * pCY) {
+    int cx0 = (pRay -> x0 < pRay -> x1 ? pRay -> x0 : pRay -> x1) >> SUBTILE_SHIFT;
+    int cx1 = (pRay -> x0 < pRay -> x1 ? pRay -> x1 : pRay -> x0) >> SUBTILE_SHIFT;
+    int cy0 = (pRay -> y0 < pRay -> y1 ? pRay -> y0 : pRay -> y1) >> SUBTILE_SHIFT;
+    int cy1 = (pRay -> y0 < pRay -> y1 ? pRay -> y1 : pRay -> y0) >> SUBTILE_SHIFT;
+    double dLow, dHigh, dBest = 2.0;
+    int bLowOpen, bHighOpen, bBestOpen = 1;
+    int cx, cy;
+    int bFound = 0;
+
+    for (cy = cy0; cy <= cy1; cy++) {
+        for (cx = cx0; cx <= cx1; cx++) {
+            if (!collisionSubTile(cx, cy))
+                continue;
+
+            dLow = 0.0;
+            dHigh = 1.0;
+            bLowOpen = bHighOpen = 0;
+            spanTimes(pRay -> x0, pRay -> x1 - pRay -> x0, cx << SUBTILE_SHIFT, & dLow, & bLowOpen, & dHigh, & bHighOpen);
+            spanTimes(pRay -> y0, pRay -> y1 - pRay -> y0, cy << SUBTILE_SHIFT, & dLow, & bLowOpen, & dHigh, & bHighOpen);
+
+            // Never inside
+            if (dLow > dHigh || (dLow == dHigh && (bLowOpen || bHighOpen)))
+                continue;
+
+            if (!bFound || dLow < dBest || (dLow == dBest && bBestOpen && !bLowOpen)) {
+                dBest = dLow;
+                bBestOpen = bLowOpen;
+                * pCX = cx;
+                * pCY = cy;
+                bFound = 1;
+            }
+        }
+    }
+
+    return bFound;
+}
+
+/**
+ * Casts random rays across the map, in batches and one at a time, and
+ * compares them with the sub-tiles each ray passes through. Returns nonzero if
+ * any ray disagreed.
+ */
+static int checkRaycast(void) {
+    RAY aRays[RAY_BATCH];
+    RAYHIT aHits[RAY_BATCH];
+    RAYHIT sHit;
+    unsigned int nSeed = 1;
+    int nMapW = g_pLevel -> width * TILE_SIZE;
+    int nMapH = g_pLevel -> height * TILE_SIZE;
+    long nRays = 0, nHits = 0, nFailed = 0;
+    int nBatch, cx, cy;
+    int i, x, y;
+    clock_t tStart, tCast = 0;
+
+    while (nRays < RAY_CHECKS) {
+        for (i = 0; i < RAY_BATCH; i++) {
+            aRays[i].x0 = nextRandom( & nSeed) % nMapW;
+            aRays[i].y0 = nextRandom( & nSeed) % nMapH;
+            x = aRays[i].x0 + (int)(nextRandom( & nSeed) % (2 * RAY_REACH + 1)) - RAY_REACH;
+            y = aRays[i].y0 + (int)(nextRandom( & nSeed) % (2 * RAY_REACH + 1)) - RAY_REACH;
+            aRays[i].x1 = x < 0 ? 0 : x >= nMapW ? nMapW - 1 : x;
+            aRays[i].y1 = y < 0 ? 0 : y >= nMapH ? nMapH - 1 : y;
+        }
+
+        tStart = clock();
+        nBatch = raycastBatch(aRays, aHits, RAY_BATCH);
+        tCast += clock() - tStart;
+
+        for (i = 0; i < RAY_BATCH; i++) {
+            // Alone, as a batch and as a line of sight
+            if (raycast(aRays[i].x0, aRays[i].y0, aRays[i].x1, aRays[i].y1, & sHit) != aHits[i].hit ||
+                sHit.cx != aHits[i].cx || sHit.cy != aHits[i].cy ||
+                lineOfSight(aRays[i].x0, aRays[i].y0, aRays[i].x1, aRays[i].y1) == aHits[i].hit)
+                nFailed++;
+
+            // The first solid sub-tile on the way
+            else if (firstSolid( & aRays[i], & cx, & cy) != aHits[i].hit || (aHits[i].hit && (cx != aHits[i].cx || cy != aHits[i].cy)))
+                nFailed++;
+
+            nBatch -= aHits[i].hit;
+            nHits += aHits[i].hit;
+        }
+
+        if (nBatch != 0)
+            nFailed++;
+        nRays += RAY_BATCH;
+    }
+
+    printf("%ld rays, %ld hit, %ld differed\n", nRays, nHits, nFailed);
+    printf("cast %.3f us per ray\n", (double) tCast * 1e6 / CLOCKS_PER_SEC / nRays);
+
+    return nFailed != 0;
+}
+
+/**
+ * Orders links by cost, then by everything else
+ *
+ * Parameters:
+ * pA			First link
+ * pB			Second link
+ */
+static int compareLinks(const void * pA, const void * pB) {
+    const NAVLINK * pLinkA = pA;
+    const NAVLINK * pLinkB = pB;
+
+    if (pLinkA -> cost != pLinkB -> cost)
+        return pLinkA -> cost - pLinkB -> cost;
+    if (pLinkA -> target != pLinkB -> target)
+        return pLinkA -> target - pLinkB -> target;
+    if (pLinkA -> fromx != pLinkB -> fromx)
+        return pLinkA -> fromx - pLinkB -> fromx;
+    if (pLinkA -> tox != pLinkB -> tox)
+        return pLinkA -> tox - pLinkB -> tox;
+
+    return pLinkA -> type - pLinkB -> type;
+}
+
+/**
+ * Compares a segment of a patched graph with the same segment of the
+ * graph built afresh, returns 1 if they match. Links are compared in
+ * order of cost; when the list is full, which of the links tied for the
+ * dearest place were kept depends on the order segments were numbered
+ * in, so only their cost has to match.
+ *
+ * Parameters:
+ * pPatched		Segment of the patched graph
+ * pSegs		All segments of the patched graph
+ * pBuilt		Segment of the graph built afresh
+ */
+static int sameSegment(const NAVSEG * pPatched, const NAVSEG * pSegs, const NAVSEG * pBuilt) {
+    NAVLINK aPatched[NAV_MAX_LINKS], aBuilt[NAV_MAX_LINKS];
+    const NAVSEG * pTarget;
+    int nDearest;
+    int i;
+
+    if (pPatched -> x1 != pBuilt -> x1 || pPatched -> hazard != pBuilt -> hazard || pPatched -> nlinks != pBuilt -> nlinks)
+        return 0;
+
+    // Targets numbered as in the graph built afresh
+    for (i = 0; i < pPatched -> nlinks; i++) {
+        aPatched[i] = pPatched -> links[i];
+        pTarget = & pSegs[aPatched[i].target];
+        aPatched[i].target = pTarget -> alive ? navSegmentAt(pTarget -> x0, pTarget -> row) : -1;
+        aBuilt[i] = pBuilt -> links[i];
+    }
+
+    qsort(aPatched, pPatched -> nlinks, sizeof(NAVLINK), compareLinks);
+    qsort(aBuilt, pBuilt -> nlinks, sizeof(NAVLINK), compareLinks);
+
+    nDearest = pBuilt -> nlinks == NAV_MAX_LINKS ? aBuilt[NAV_MAX_LINKS - 1].cost : -1;
+
+    for (i = 0; i < pPatched -> nlinks; i++) {
+        if (aPatched[i].cost != aBuilt[i].cost)
+            return 0;
+        if (aPatched[i].cost != nDearest && compareLinks( & aPatched[i], & aBuilt[i]) != 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Changes random tiles of the map a few at a time, letting levelSetBlock
+ * patch the platform graph, and after every round compares the patched
+ * graph with one built afresh from the same map: the same segments on
+ * the same sub-tiles, with the same hazards and links. Reports how long
+ * patching and building take. Returns nonzero if any round differed.
+ */
+static int checkNav(void) {
+    NAVSEG * pSaved = NULL;
+    short * pAt;
+    unsigned int nSeed = 1;
+    int nSubTiles = g_nCollisionW * g_nCollisionH;
+    long nEdits = 0, nFailed = 0;
+    int nRound, nCount, nSaved;
+    int tx, ty, cx, cy, nSeg;
+    int i;
+    double dStart, dPatch = 0, dBuild = 0;
+
+    pAt = malloc(nSubTiles * sizeof(short));
+    if (pAt == NULL)
+        return 1;
+
+    for (nRound = 0; nRound < NAV_ROUNDS; nRound++) {
+        // A few tiles close together, with whatever blocks
+        tx = nextRandom( & nSeed) % g_pLevel -> width;
+        ty = nextRandom( & nSeed) % g_pLevel -> height;
+        nCount = 1 + nextRandom( & nSeed) % NAV_EDITS;
+
+        dStart = paceNow();
+        for (i = 0; i < nCount; i++) {
+            cx = tx + (int)(nextRandom( & nSeed) % (2 * NAV_SPREAD + 1)) - NAV_SPREAD;
+            cy = ty + (int)(nextRandom( & nSeed) % (2 * NAV_SPREAD + 1)) - NAV_SPREAD;
+            if (cx < 0 || cy < 0 || cx >= g_pLevel -> width || cy >= g_pLevel -> height)
+                continue;
+
+            levelSetBlock(cx, cy, nextRandom( & nSeed) % g_pLevel -> nblocks);
+            nEdits++;
+        }
+        dPatch += paceNow() - dStart;
+
+        // Keep the patched graph
+        nSaved = g_nNavSegs;
+        free(pSaved);
+        pSaved = malloc(nSaved * sizeof(NAVSEG));
+        if (pSaved == NULL) {
+            free(pAt);
+            return 1;
+        }
+        memcpy(pSaved, g_pNavSegs, nSaved * sizeof(NAVSEG));
+        for (cy = 0; cy < g_nCollisionH; cy++)
+            for (cx = 0; cx < g_nCollisionW; cx++)
+                pAt[cy * g_nCollisionW + cx] = navSegmentAt(cx, cy);
+
+        dStart = paceNow();
+        navBuild();
+        dBuild += paceNow() - dStart;
+
+        // Every sub-tile on the same segment, and every segment the same
+        for (i = 0; i < nSubTiles; i++) {
+            nSeg = navSegmentAt(i % g_nCollisionW, i / g_nCollisionW);
+            if ((nSeg < 0) != (pAt[i] < 0) ||
+                (nSeg >= 0 && (!pSaved[pAt[i]].alive || pSaved[pAt[i]].x0 != g_pNavSegs[nSeg].x0 ||
+                    !sameSegment( & pSaved[pAt[i]], pSaved, & g_pNavSegs[nSeg]))))
+                break;
+        }
+
+        // And no segment left over
+        for (nCount = 0, nSeg = 0; nSeg < nSaved; nSeg++)
+            nCount += pSaved[nSeg].alive;
+
+        if (i < nSubTiles || nCount != g_nNavSegs)
+            nFailed++;
+    }
+
+    printf("%d rounds of %ld edits, %ld differed\n", NAV_ROUNDS, nEdits, nFailed);
+    printf("patch %.2f us per edit, build %.2f us\n", dPatch / nEdits, dBuild / NAV_ROUNDS);
+
+    free(pSaved);
+    free(pAt);
+
+    return nFailed != 0;
+}
+
+/**
+ * Walks a route link by link and adds up its cost the way the search
+ * does, returns 1 if it leads from one segment to the other at the cost
+ * given
+ *
+ * Parameters:
+ * pPath		Route to follow
+ */
+static int validRoute(const PATH * pPath) {
+    NAVLINK * pLink;
+    int nSeg = pPath -> from;
+    int nEntry = -1;
+    int nCost = 0;
+    int i;
+
+    for (i = 0; i < pPath -> nsteps; i++) {
+        if (pPath -> steps[i].seg != nSeg || !g_pNavSegs[nSeg].alive ||
+            pPath -> steps[i].link < 0 || pPath -> steps[i].link >= g_pNavSegs[nSeg].nlinks)
+            return 0;
+
+        pLink = & g_pNavSegs[nSeg].links[pPath -> steps[i].link];
+        nCost += (nEntry < 0 ? 0 : abs(pLink -> fromx - nEntry) << SUBTILE_SHIFT) / NAV_WALK_SPEED + pLink -> cost;
+        if (pLink -> type & NAV_HAZARD)
+            nCost += PATH_HAZARD_COST;
+
+        nEntry = pLink -> tox;
+        nSeg = pLink -> target;
+    }
+
+    return nSeg == pPath -> to && nCost == pPath -> cost;
+}
+
+/**
+ * Checks whether one segment can be reached from another within
+ * PATH_MAX_STEPS links, by breadth first search
+ *
+ * Parameters:
+ * from			Starting segment
+ * to			Destination segment
+ * pHops		Scratch, one per segment
+ * pQueue		Scratch, one per segment
+ */
+static int reachable(int from, int to, short * pHops, short * pQueue) {
+    NAVSEG * pSeg;
+    int nHead = 0, nTail = 0;
+    int i;
+
+    for (i = 0; i < g_nNavSegs; i++)
+        pHops[i] = -1;
+
+    pHops[from] = 0;
+    pQueue[nTail++] = from;
+
+    while (nHead < nTail) {
+        pSeg = & g_pNavSegs[pQueue[nHead]];
+        if (pQueue[nHead] == to)
+            return 1;
+
+        if (pHops[pQueue[nHead]] < PATH_MAX_STEPS) {
+            for (i = 0; i < pSeg -> nlinks; i++) {
+                if (pHops[pSeg -> links[i].target] >= 0)
+                    continue;
+
+                pHops[pSeg -> links[i].target] = pHops[pQueue[nHead]] + 1;
+                pQueue[nTail++] = pSeg -> links[i].target;
+            }
+        }
+
+        nHead++;
+    }
+
+    return 0;
+}
+
+/**
+ * Asks for routes between the segments below random points of the map, a
+ * queue full at a time so the searches share the frame budget, and checks
+ * that every route found follows the links of the graph at the cost
+ * given and that none is missed. Reports how many frames a batch took and
+ * how long each frame took. Returns nonzero if any route was wrong or
+ * never came.
+ */
+static int checkPaths(void) {
+    PATH sPath;
+    short aFrom[PATH_QUEUE_SIZE], aTo[PATH_QUEUE_SIZE];
+    unsigned int nSeed = 1;
+    int nMapW = g_pLevel -> width * TILE_SIZE;
+    int nMapH = g_pLevel -> height * TILE_SIZE;
+    long nRoutes = 0, nFound = 0, nFailed = 0;
+    long nFrames = 0, nBatches = 0, nMost = 0;
+    int nLeft, nResult, nFrame;
+    int i;
+    short * pHops;
+    short * pQueue;
+    double dStart, dTaken, dWorst = 0, dTotal = 0;
+
+    pHops = malloc(g_nNavSegs * sizeof(short));
+    pQueue = malloc(g_nNavSegs * sizeof(short));
+    if (pHops == NULL || pQueue == NULL) {
+        free(pHops);
+        free(pQueue);
+        return 1;
+    }
+
+    while (nRoutes < PATH_CHECKS) {
+        // Where an actor dropped at each point would stand
+        for (i = 0; i < PATH_QUEUE_SIZE; i++) {
+            do {
+                aFrom[i] = navSegmentBelow(nextRandom( & nSeed) % nMapW, nextRandom( & nSeed) % nMapH);
+                aTo[i] = navSegmentBelow(nextRandom( & nSeed) % nMapW, nextRandom( & nSeed) % nMapH);
+            } while (aFrom[i] < 0 || aTo[i] < 0);
+        }
+
+        // Ask again every frame until all are decided
+        nLeft = PATH_QUEUE_SIZE;
+        for (nFrame = 1; nLeft > 0 && nFrame <= PATH_FRAMES; nFrame++) {
+            pathFrame();
+            dTaken = 0;
+
+            for (i = 0; i < PATH_QUEUE_SIZE; i++) {
+                if (aFrom[i] < 0)
+                    continue;
+
+                dStart = paceNow();
+                nResult = pathFind(aFrom[i], aTo[i], & sPath);
+                dTaken += paceNow() - dStart;
+
+                if (nResult == PATH_PENDING)
+                    continue;
+
+                if (nResult == PATH_FOUND) {
+                    if (sPath.from != aFrom[i] || sPath.to != aTo[i] || !validRoute( & sPath))
+                        nFailed++;
+                    nFound++;
+                } else if (reachable(aFrom[i], aTo[i], pHops, pQueue)) {
+                    nFailed++;
+                }
+
+                aFrom[i] = -1;
+                nLeft--;
+            }
+
+            dTotal += dTaken;
+            if (dTaken > dWorst)
+                dWorst = dTaken;
+        }
+
+        // Never decided
+        nFailed += nLeft;
+
+        nFrames += nFrame - 1;
+        if (nFrame - 1 > nMost)
+            nMost = nFrame - 1;
+        nBatches++;
+        nRoutes += PATH_QUEUE_SIZE;
+    }
+
+    printf("%ld routes, %ld found, %ld differed\n", nRoutes, nFound, nFailed);
+    printf("%d routes at a time took %.2f frames on average, %ld at most\n", PATH_QUEUE_SIZE, (double) nFrames / nBatches, nMost);
+    printf("frame %.2f us on average, %.2f us at most\n", dTotal / nFrames, dWorst);
+
+    free(pHops);
+    free(pQueue);
+
+    return nFailed != 0;
+}
+
+/**
+ * Spreads plants evenly over the map past the player's start, as if the
+ * map had that many spawners, and starts a new game with them. Maps with
+ * spawner blocks of their own keep those. Returns nonzero if out of
+ * memory.
+ *
+ * Parameters:
+ * nPlants		Number of plants
+ */
+static int buildCrowd(int nPlants) {
+    SPAWNER * pSpawners;
+    int nSpan = MAP_WIDTH * 32 - CROWD_FIRST;
+    int nRows = (MAP_HEIGHT * 32 - PLANT_H) / CROWD_ROW;
+    int i;
+
+    pSpawners = malloc(nPlants * sizeof(SPAWNER));
+    if (pSpawners == NULL)
+        return 1;
+
+    for (i = 0; i < nPlants; i++) {
+        pSpawners[i].x = CROWD_FIRST + (int)((long) nSpan * i / nPlants);
+        pSpawners[i].y = CROWD_ROW * (i % nRows);
+        pSpawners[i].kind = KIND_PLANT;
+        pSpawners[i].done = 0;
+    }
+
+    if (regionBuild(pSpawners, nPlants) != 0) {
+        free(pSpawners);
+        return 1;
+    }
+    free(pSpawners);
+
+    simReset();
+
+    return 0;
+}
+
+/**
+ * Plays the same ticks with the scripted player on 1, 2 and 4 threads,
+ * starting from the same snapshot, and compares the checksum of every
+ * tick with the one on a single thread. Reports how many partitions a
+ * tick was split into on average, which stays at 1 until there are
+ * SIM_PARALLEL_MIN awake actors per thread; use -crowd for more. Returns
+ * nonzero if any tick differed.
+ *
+ * Parameters:
+ * nTicks		Ticks to play
+ */
+static int checkParallel(long nTicks) {
+    unsigned char * pSnap;
+    unsigned int * pSums;
+    size_t nSize;
+    long nTick, nFailed, nParts;
+    long nDiffered = 0;
+    int nThreads;
+    int i;
+    double dStart;
+
+    nSize = snapSave(NULL, 0, 0);
+    pSnap = malloc(nSize);
+    pSums = malloc(nTicks * sizeof(unsigned int));
+    if (pSnap == NULL || pSums == NULL) {
+        free(pSnap);
+        free(pSums);
+        return 1;
+    }
+    snapSave(pSnap, nSize, 0);
+
+    for (i = 0; i < (int)(sizeof(s_aParallel) / sizeof(s_aParallel[0])); i++) {
+        snapLoad(pSnap, nSize);
+        nThreads = simThreads(s_aParallel[i]);
+        nFailed = 0;
+        nParts = 0;
+
+        dStart = paceNow();
+        for (nTick = 0; nTick < nTicks; nTick++) {
+            simTick(botInput(nTick));
+            nParts += simPartitions();
+
+            if (i == 0)
+                pSums[nTick] = simChecksum();
+            else if (simChecksum() != pSums[nTick])
+                nFailed++;
+
+            g_pLevel -> ndirty = 0;
+            g_pLevel -> alldirty = 0;
+        }
+
+        printf("%d threads: %ld ticks differed, %.2f partitions per tick, %.3f s\n", nThreads, nFailed,
+            (double) nParts / nTicks, (paceNow() - dStart) / 1e6);
+        nDiffered += nFailed;
+    }
+
+    free(pSnap);
+    free(pSums);
+
+    return nDiffered != 0;
+}
+
+/**
+ * Snapshots the game into a buffer, growing it as needed. Returns -1 if
+ * out of memory.
+ *
+ * Parameters:
+ * ppSnap		Buffer, may be NULL to start with
+ * pCap			Size of the buffer
+ * pSize		Receives the size of the snapshot
+ */
+static int saveGrowing(unsigned char ** ppSnap, size_t * pCap, size_t * pSize) {
+    unsigned char * pNew;
+
+    * pSize = snapSave(NULL, 0, 0);
+    if ( * pSize > * pCap) {
+        pNew = realloc( * ppSnap, * pSize);
+        if (pNew == NULL)
+            return -1;
+
+        * ppSnap = pNew;
+        * pCap = * pSize;
+    }
+
+    snapSave( * ppSnap, * pCap, 0);
+    return 0;
+}
+
+/**
+ * Orders the fields of two actors, as gathered by gatherActors
+ *
+ * Parameters:
+ * pA			First actor
+ * pB			Second actor
+ */
+static int compareActors(const void * pA, const void * pB) {
+    const int * a = pA;
+    const int * b = pB;
+    int f;
+
+    for (f = 0; f < DETAIL_FIELDS; f++)
+        if (a[f] != b[f])
+            return a[f] < b[f] ? -1 : 1;
+
+    return 0;
+}
+
+/**
+ * Gathers the fields of the actors in use, sorted, leaving out those
+ * still owed ticks if asked. Returns how many, or -1 if out of memory.
+ *
+ * Parameters:
+ * ppFields		Buffer, grown as needed
+ * pCap			Actors the buffer holds
+ * bCaughtUp	Whether to leave out actors owed ticks
+ */
+static int gatherActors(int ** ppFields, int * pCap, int bCaughtUp) {
+    int * pNew;
+    int * p;
+    int i, n = 0;
+
+    if (g_sActors.count > * pCap) {
+        pNew = realloc( * ppFields, g_sActors.count * DETAIL_FIELDS * sizeof(int));
+        if (pNew == NULL)
+            return -1;
+        * ppFields = pNew;
+        * pCap = g_sActors.count;
+    }
+
+    for (i = 0; i < g_sActors.count; i++) {
+        if (!g_sActors.used[i] || (bCaughtUp && g_sActors.owed[i] > 0))
+            continue;
+
+        p = * ppFields + n++ * DETAIL_FIELDS;
+        p[0] = g_sActors.kind[i];
+        p[1] = g_sActors.x[i];
+        p[2] = g_sActors.y[i];
+        p[3] = g_sActors.jump[i];
+        p[4] = g_sActors.dir[i];
+        p[5] = g_sActors.alive[i];
+        p[6] = g_sActors.frame[i];
+    }
+
+    qsort( * ppFields, n, DETAIL_FIELDS * sizeof(int), compareActors);
+
+    return n;
+}
+
+/**
+ * Plays the same ticks with the scripted player twice from the same
+ * snapshot, once updating every awake actor each tick and once with the
+ * distant ones on SIM_DETAIL_EVERY, taking turns a tick at a time. After
+ * each tick, every actor of the second game that owes no ticks must have
+ * its double in the first. Slots are not compared, as an actor that dies
+ * in a catch-up frees its slot a few ticks later. Use -crowd for enough
+ * distant actors. Returns nonzero if any actor differed.
+ *
+ * Parameters:
+ * nTicks		Ticks to play
+ */
+static int checkDetail(long nTicks) {
+    unsigned char * aSnaps[2] = { NULL, NULL };
+    size_t aCaps[2] = { 0, 0 };
+    size_t aSizes[2];
+    int * pFull = NULL; // Actors of the game at full rate
+    int * pDetail = NULL; // Caught up actors of the other
+    int nFullCap = 0, nDetailCap = 0;
+    int nFull, nDetail;
+    long nTick;
+    long nCompared = 0, nOwing = 0, nDiffered = 0;
+    int i, j;
+
+    if (saveGrowing( & aSnaps[0], & aCaps[0], & aSizes[0]) != 0 ||
+        saveGrowing( & aSnaps[1], & aCaps[1], & aSizes[1]) != 0)
+        goto fail;
+
+    for (nTick = 0; nTick < nTicks; nTick++) {
+        // At full rate
+        snapLoad(aSnaps[0], aSizes[0]);
+        simDetailRate(1);
+        simTick(botInput(nTick));
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+
+        nFull = gatherActors( & pFull, & nFullCap, 0);
+        if (nFull < 0 || saveGrowing( & aSnaps[0], & aCaps[0], & aSizes[0]) != 0)
+            goto fail;
+
+        // With the distant actors on their turns
+        snapLoad(aSnaps[1], aSizes[1]);
+        simDetailRate(SIM_DETAIL_EVERY);
+        simTick(botInput(nTick));
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+
+        nDetail = gatherActors( & pDetail, & nDetailCap, 1);
+        if (nDetail < 0 || saveGrowing( & aSnaps[1], & aCaps[1], & aSizes[1]) != 0)
+            goto fail;
+
+        nOwing += g_sActors.live - nDetail;
+        nCompared += nDetail;
+
+        // Both sorted, so each caught up actor is looked for past the last
+        for (i = 0, j = 0; i < nDetail; i++) {
+            while (j < nFull && compareActors(pFull + j * DETAIL_FIELDS, pDetail + i * DETAIL_FIELDS) < 0)
+                j++;
+
+            if (j < nFull && compareActors(pFull + j * DETAIL_FIELDS, pDetail + i * DETAIL_FIELDS) == 0)
+                j++;
+            else
+                nDiffered++;
+        }
+    }
+
+    simDetailRate(SIM_DETAIL_EVERY);
+
+    printf("%ld ticks, %ld actors compared, %ld differed; %ld left out while owed ticks\n",
+        nTicks, nCompared, nDiffered, nOwing);
+
+    free(aSnaps[0]);
+    free(aSnaps[1]);
+    free(pFull);
+    free(pDetail);
+
+    return nDiffered != 0;
+
+fail:
+    fprintf(stderr, "Out of memory\n");
+    free(aSnaps[0]);
+    free(aSnaps[1]);
+    free(pFull);
+    free(pDetail);
+
+    return 1;
+}
+
+/**
+ * Entry point for the headless driver
+ *
+ * Usage: headless [-record file | -replay file | -snapshots | -rewind | -raycast | -paths | -nav | -parallel | -detail | -pace] [-threads n] [-crowd plants] [map file] [ticks]
+ */
+int main(int argc, char * argv[]) {
+    const char * szMap = "map.fmp";
+    const char * szRecord = NULL;
+    const char * szReplay = NULL;
+    int nThreads = 1;
+    int bSnapshots = 0;
+    int bRewind = 0;
+    int bRaycast = 0;
+    int bPaths = 0;
+    int bNav = 0;
+    int bParallel = 0;
+    int bDetail = 0;
+    int nCrowd = 0;
+    int bPace = 0; // Tick at TICK_RATE like the game
+    PACER sPacer;
+    long nTicks = DEFAULT_TICKS;
+    long nTick;
+    int nInput;
+    int nArg = 1;
+    int nResult;
+    int i;
+    REPLAY * pRecording = NULL;
+    long nGames = 0; // Games finished
+    long nWins = 0; // Games won
+    long nBest = 0; // Best score
+    long aEvents[EVENT_TIMEUP + 1]; // Events seen, by type
+    double dUpdated = 0, dLive = 0; // Actors updated and alive, over all ticks
+    double dStart;
+    double dSeconds;
+
+    // Options first, then the positional arguments
+    for (; nArg < argc && argv[nArg][0] == '-'; nArg++) {
+        if (!strcmp(argv[nArg], "-snapshots"))
+            bSnapshots = 1;
+        else if (!strcmp(argv[nArg], "-rewind"))
+            bRewind = 1;
+        else if (!strcmp(argv[nArg], "-raycast"))
+            bRaycast = 1;
+        else if (!strcmp(argv[nArg], "-paths"))
+            bPaths = 1;
+        else if (!strcmp(argv[nArg], "-nav"))
+            bNav = 1;
+        else if (!strcmp(argv[nArg], "-parallel"))
+            bParallel = 1;
+        else if (!strcmp(argv[nArg], "-detail"))
+            bDetail = 1;
+        else if (!strcmp(argv[nArg], "-pace"))
+            bPace = 1;
+        else if (nArg + 1 == argc)
+            break;
+        else if (!strcmp(argv[nArg], "-record"))
+            szRecord = argv[++nArg];
+        else if (!strcmp(argv[nArg], "-replay"))
+            szReplay = argv[++nArg];
+        else if (!strcmp(argv[nArg], "-threads"))
+            nThreads = atoi(argv[++nArg]);
+        else if (!strcmp(argv[nArg], "-crowd"))
+            nCrowd = atoi(argv[++nArg]);
+        else
+            nArg++;
+    }
+
+    if (nArg < argc)
+        szMap = argv[nArg++];
+    if (nArg < argc)
+        nTicks = atol(argv[nArg]);
+
+    if (simInit(szMap) != 0) {
+        fprintf(stderr, "Error loading map %s\n", szMap);
+        return 1;
+    }
+
+    if (nCrowd > 0 && buildCrowd(nCrowd) != 0) {
+        simShutdown();
+        return 1;
+    }
+
+    if (nThreads > 1)
+        printf("Updating actors on %d threads\n", simThreads(nThreads));
+
+    if (szReplay != NULL) {
+        nResult = playReplay(szReplay);
+        simShutdown();
+        return nResult;
+    }
+
+    if (bSnapshots) {
+        nResult = checkSnapshots(nTicks);
+        simShutdown();
+        return nResult;
+    }
+
+    if (bRewind) {
+        nResult = checkRewind(nTicks);
+        simShutdown();
+        return nResult;
+    }
+
+    if (bRaycast) {
+        nResult = checkRaycast();
+        simShutdown();
+        return nResult;
+    }
+
+    if (bPaths) {
+        nResult = checkPaths();
+        simShutdown();
+        return nResult;
+    }
+
+    if (bNav) {
+        nResult = checkNav();
+        simShutdown();
+        return nResult;
+    }
+
+    if (bParallel) {
+        nResult = checkParallel(nTicks);
+        simShutdown();
+        return nResult;
+    }
+
+    if (bDetail) {
+        nResult = checkDetail(nTicks);
+        simShutdown();
+        return nResult;
+    }
+
+    if (szRecord != NULL)
+        pRecording = replayCreate();
+
+    memset(aEvents, 0, sizeof(aEvents));
+
+    // Wall clock time, the CPU time of every thread would add up
+    dStart = paceNow();
+    if (bPace)
+        paceStart( & sPacer, "ticks", 1e6 / TICK_RATE);
+
+    for (nTick = 0; nTick < nTicks; nTick++) {
+        if (bPace)
+            paceWait( & sPacer);
+
+        // Game is over and the bot restarts this tick, record it first
+        if (!g_sActors.alive[PLAYER]) {
+            nGames++;
+            nWins += g_bVictory;
+            if (g_nPlayerScore > nBest)
+                nBest = g_nPlayerScore;
+        }
+
+        nInput = botInput(nTick);
+        dLive += g_sActors.live;
+        simTick(nInput);
+        dUpdated += g_nAwake;
+
+        if (pRecording != NULL)
+            replayRecord(pRecording, nInput, simChecksum());
+
+        for (i = 0; i < g_sEvents.count; i++)
+            aEvents[g_sEvents.events[i].type]++;
+
+        // The renderer is not there to catch up on changed cells
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+    }
+
+    dSeconds = (paceNow() - dStart) / 1e6;
+
+    printf("%ld ticks in %.3f s", nTicks, dSeconds);
+    if (dSeconds > 0)
+        printf(", %.0f ticks/s", nTicks / dSeconds);
+    printf("\n%ld games, %ld won, best score %ld\n", nGames, nWins, nBest);
+    printf("%ld jumps, %ld gems, %ld deaths, %ld out of time\n",
+        aEvents[EVENT_JUMP], aEvents[EVENT_GEM], aEvents[EVENT_DEATH], aEvents[EVENT_TIMEUP]);
+    printf("%.1f of %.1f actors updated per tick\n", dUpdated / nTicks, dLive / nTicks);
+
+    // Processor time above against the time it took on the clock
+    if (bPace) {
+        paceReport( & sPacer, stdout);
+        if (sPacer.last > sPacer.start)
+            printf("busy %.1f%% of %.3f s\n", dSeconds * 1e8 / (sPacer.last - sPacer.start), (sPacer.last - sPacer.start) / 1e6);
+    }
+
+    if (pRecording != NULL) {
+        if (replaySave(pRecording, szRecord) != 0)
+            fprintf(stderr, "Error saving replay %s\n", szRecord);
+        replayFree(pRecording);
+    }
+
+    simShutdown();
+
+    return 0;
+}
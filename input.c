@@ -0,0 +1,91 @@
+/**
+ * File:        input.c
+ * Purpose:     Timestamped key changes handed from the thread that sees
+ *              them to the tick they belong to
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include "input.h"
+
+/**
+ * Queues a button change, only ever called from one thread. Returns -1
+ * if the queue was full and the change was dropped.
+ *
+ * Parameters:
+ * pQueue		Queue to add to
+ * dTime		When the change happened, on the pace.c clock
+ * nButtons		Buttons that changed
+ * bDown		Nonzero if they went down, zero if they came up
+ */
+int inputPush(INPUTQUEUE * pQueue, double dTime, int nButtons, int bDown) {
+    unsigned int nHead = pQueue -> head;
+    INPUTEVENT * pEvent;
+
+    if (nHead - __atomic_load_n( & pQueue -> tail, __ATOMIC_ACQUIRE) == INPUT_QUEUE_SIZE) {
+        pQueue -> dropped++;
+        return -1;
+    }
+
+    pEvent = & pQueue -> events[nHead & (INPUT_QUEUE_SIZE - 1)];
+    pEvent -> time = dTime;
+    pEvent -> buttons = nButtons;
+    pEvent -> down = bDown;
+
+    // The change is written before the reader can see it
+    __atomic_store_n( & pQueue -> head, nHead + 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/**
+ * Takes the button changes that happened before a tick ended, only ever
+ * called from one thread. Returns the buttons for the tick: those held
+ * at its end, and those pressed during it even if already let go, so a
+ * tap shorter than a tick still counts. Changes after the tick stay
+ * queued for the next.
+ *
+ * Parameters:
+ * pState		Buttons so far, pressed is set to those newly down
+ * pQueue		Queue to take from
+ * dBefore		When the tick ended, on the pace.c clock
+ * dNow			When the tick runs, to time presses by, 0 for untimed
+ */
+int inputTake(INPUTSTATE * pState, INPUTQUEUE * pQueue, double dBefore, double dNow) {
+    unsigned int nTail = pQueue -> tail;
+    unsigned int nHead = __atomic_load_n( & pQueue -> head, __ATOMIC_ACQUIRE);
+    INPUTEVENT * pEvent;
+    int nNew;
+
+    pState -> pressed = 0;
+
+    for (; nTail != nHead; nTail++) {
+        pEvent = & pQueue -> events[nTail & (INPUT_QUEUE_SIZE - 1)];
+        if (pEvent -> time > dBefore)
+            break;
+
+        if (pEvent -> down) {
+            // Key repeat sends more downs for a button already held
+            nNew = pEvent -> buttons & ~pState -> held;
+            pState -> held |= nNew;
+            pState -> pressed |= nNew;
+
+            if (nNew && dNow > 0) {
+                pState -> presses++;
+                pState -> latency += dNow - pEvent -> time;
+                if (dNow - pEvent -> time > pState -> worst)
+                    pState -> worst = dNow - pEvent -> time;
+            }
+        } else {
+            pState -> held &= ~pEvent -> buttons;
+        }
+    }
+
+    // Done reading the slots, the writer may have them back
+    __atomic_store_n( & pQueue -> tail, nTail, __ATOMIC_RELEASE);
+
+    return pState -> held | pState -> pressed;
+}
@@ -0,0 +1,55 @@
+/**
+ * File:        input.h
+ * Purpose:     Header file for input.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _INPUT_H_
+#define _INPUT_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Key changes the queue holds, a power of two
+#define INPUT_QUEUE_SIZE 256
+
+// A button going down or up, and when
+typedef struct INPUTEVENT
+{
+	double time;
+	int buttons;
+	int down;
+} INPUTEVENT;
+
+// Key changes from the thread that sees them to the loop that uses them.
+// One thread pushes and one pops, neither waits for the other.
+typedef struct INPUTQUEUE
+{
+	unsigned int head;
+	unsigned int tail;
+	long dropped;
+	INPUTEVENT events[INPUT_QUEUE_SIZE];
+} INPUTQUEUE;
+
+// Buttons as the loop using them has seen them so far
+typedef struct INPUTSTATE
+{
+	int held;
+	int pressed;
+
+	// Time from a button going down to the tick that used it
+	long presses;
+	double latency;
+	double worst;
+} INPUTSTATE;
+
+// Function declarations
+int inputPush(INPUTQUEUE * pQueue, double dTime, int nButtons, int bDown);
+int inputTake(INPUTSTATE * pState, INPUTQUEUE * pQueue, double dBefore, double dNow);
+
+#endif
@@ -0,0 +1,370 @@
+/**
+ * File:        job.c
+ * Purpose:     Work-stealing task scheduler: each thread keeps a deque of
+ *              tasks, runs its own newest first and takes the oldest of
+ *              another's when it runs out
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <sched.h>
+
+#include "pthread.h"
+
+#include "job.h"
+
+// A range of items of a job, split in halves while above the grain
+typedef struct JOBTASK
+{
+	JOBFUNC pfn;
+	void * data;
+	int first, last;
+	int grain;
+	JOBGROUP * group;
+} JOBTASK;
+
+// Tasks of one thread: the owner pushes and pops at the bottom, others
+// steal from the top. Positions only grow, slots wrap around.
+typedef struct JOBDEQUE
+{
+	pthread_mutex_t lock;
+	int top;
+	int bottom;
+	JOBTASK tasks[JOB_DEQUE_SIZE];
+	JOBSTATS stats;
+} JOBDEQUE;
+
+// Deques of every thread, the one that started the pool is 0
+static JOBDEQUE s_aDeques[JOB_MAX_THREADS];
+static int s_bReady = 0;
+
+// Threads of the pool, not counting the caller
+static pthread_t s_aThreads[JOB_MAX_THREADS];
+static int s_nThreads = 1;
+
+// Deque of the calling thread, 0 for threads outside the pool as well
+static __thread int s_nSelf = 0;
+
+// Idle threads sleep until tasks are queued anywhere
+static pthread_mutex_t s_sIdleLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_sIdleWake = PTHREAD_COND_INITIALIZER;
+static int s_nQueued = 0;
+static int s_nSleeping = 0;
+static int s_bQuit = 0;
+
+// Timing hook, NULL for none
+static JOBHOOK s_pfnHook = NULL;
+
+/**
+ * Queues a task on a thread's deque. Returns -1 if the deque is full.
+ *
+ * Parameters:
+ * nSelf		Thread whose deque to use
+ * pTask		Task to queue
+ */
+static int jobPush(int nSelf, const JOBTASK * pTask) {
+    JOBDEQUE * pDeque = & s_aDeques[nSelf];
+
+    pthread_mutex_lock( & pDeque -> lock);
+    if (pDeque -> bottom - pDeque -> top == JOB_DEQUE_SIZE) {
+        pthread_mutex_unlock( & pDeque -> lock);
+        return -1;
+    }
+    pDeque -> tasks[pDeque -> bottom % JOB_DEQUE_SIZE] = * pTask;
+    pDeque -> bottom++;
+    pthread_mutex_unlock( & pDeque -> lock);
+
+    // Wake a sleeper, who either sees the count or is already waiting
+    __atomic_add_fetch( & s_nQueued, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n( & s_nSleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock( & s_sIdleLock);
+        pthread_cond_signal( & s_sIdleWake);
+        pthread_mutex_unlock( & s_sIdleLock);
+    }
+
+    return 0;
+}
+
+/**
+ * Takes a task for a thread, its own newest first, else the oldest of
+ * another thread. Returns 0 if there was none.
+ *
+ * Parameters:
+ * nSelf		Thread looking for work
+ * pTask		Receives the task
+ */
+static int jobFind(int nSelf, JOBTASK * pTask) {
+    JOBDEQUE * pDeque = & s_aDeques[nSelf];
+    int i, v;
+
+    if (__atomic_load_n( & s_nQueued, __ATOMIC_ACQUIRE) == 0)
+        return 0;
+
+    pthread_mutex_lock( & pDeque -> lock);
+    if (pDeque -> bottom > pDeque -> top) {
+        pDeque -> bottom--;
+        * pTask = pDeque -> tasks[pDeque -> bottom % JOB_DEQUE_SIZE];
+        pthread_mutex_unlock( & pDeque -> lock);
+        __atomic_sub_fetch( & s_nQueued, 1, __ATOMIC_SEQ_CST);
+        return 1;
+    }
+    pthread_mutex_unlock( & pDeque -> lock);
+
+    // Steal the biggest piece left, the oldest, starting with the next thread
+    for (i = 1; i < s_nThreads; i++) {
+        v = (nSelf + i) % s_nThreads;
+        pDeque = & s_aDeques[v];
+
+        pthread_mutex_lock( & pDeque -> lock);
+        if (pDeque -> bottom > pDeque -> top) {
+            * pTask = pDeque -> tasks[pDeque -> top % JOB_DEQUE_SIZE];
+            pDeque -> top++;
+            pthread_mutex_unlock( & pDeque -> lock);
+            __atomic_sub_fetch( & s_nQueued, 1, __ATOMIC_SEQ_CST);
+            s_aDeques[nSelf].stats.steals++;
+            return 1;
+        }
+        pthread_mutex_unlock( & pDeque -> lock);
+    }
+
+    return 0;
+}
+
+/**
+ * Runs a task, first splitting off upper halves for others to steal while
+ * it is larger than its grain
+ *
+ * Parameters:
+ * nSelf		Thread running the task
+ * pTask		Task to run
+ */
+static void jobExecute(int nSelf, JOBTASK * pTask) {
+    JOBTASK sHalf;
+
+    while (s_nThreads > 1 && pTask -> last - pTask -> first > pTask -> grain) {
+        sHalf = * pTask;
+        sHalf.first = pTask -> first + (pTask -> last - pTask -> first) / 2;
+
+        __atomic_add_fetch( & pTask -> group -> pending, 1, __ATOMIC_ACQ_REL);
+        if (jobPush(nSelf, & sHalf) != 0) {
+            // No room, keep the whole range
+            __atomic_sub_fetch( & pTask -> group -> pending, 1, __ATOMIC_ACQ_REL);
+            break;
+        }
+
+        pTask -> last = sHalf.first;
+        s_aDeques[nSelf].stats.splits++;
+    }
+
+    if (s_pfnHook != NULL)
+        s_pfnHook(nSelf, pTask -> pfn, pTask -> first, pTask -> last, 0);
+
+    pTask -> pfn(pTask -> data, pTask -> first, pTask -> last);
+
+    if (s_pfnHook != NULL)
+        s_pfnHook(nSelf, pTask -> pfn, pTask -> first, pTask -> last, 1);
+
+    s_aDeques[nSelf].stats.tasks++;
+
+    // Whatever the task wrote is visible to whoever sees the group finish
+    __atomic_sub_fetch( & pTask -> group -> pending, 1, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * Runs tasks from any deque, sleeping while there are none, until the
+ * pool stops
+ *
+ * Parameters:
+ * pArg			Deque of the thread
+ */
+static void * jobThread(void * pArg) {
+    JOBTASK sTask;
+    int bQuit = 0;
+
+    s_nSelf = (int)(size_t) pArg;
+
+    while (!bQuit) {
+        if (jobFind(s_nSelf, & sTask)) {
+            jobExecute(s_nSelf, & sTask);
+            continue;
+        }
+
+        pthread_mutex_lock( & s_sIdleLock);
+        __atomic_add_fetch( & s_nSleeping, 1, __ATOMIC_SEQ_CST);
+        while (!s_bQuit && __atomic_load_n( & s_nQueued, __ATOMIC_SEQ_CST) == 0)
+            pthread_cond_wait( & s_sIdleWake, & s_sIdleLock);
+        __atomic_sub_fetch( & s_nSleeping, 1, __ATOMIC_SEQ_CST);
+        bQuit = s_bQuit;
+        pthread_mutex_unlock( & s_sIdleLock);
+    }
+
+    return NULL;
+}
+
+/**
+ * Starts the pool. Returns the number of threads that will run tasks, the
+ * calling thread included, which runs them while it waits.
+ *
+ * Parameters:
+ * nThreads		Threads wanted, the calling thread included
+ */
+int jobStart(int nThreads) {
+    int i;
+
+    jobStop();
+
+    if (!s_bReady) {
+        for (i = 0; i < JOB_MAX_THREADS; i++)
+            pthread_mutex_init( & s_aDeques[i].lock, NULL);
+        s_bReady = 1;
+    }
+
+    if (nThreads > JOB_MAX_THREADS)
+        nThreads = JOB_MAX_THREADS;
+
+    s_bQuit = 0;
+    s_nSelf = 0;
+    for (s_nThreads = 1; s_nThreads < nThreads; s_nThreads++)
+        if (pthread_create( & s_aThreads[s_nThreads], NULL, jobThread, (void * )(size_t) s_nThreads) != 0)
+            break;
+
+    return s_nThreads;
+}
+
+/**
+ * Stops the threads of the pool, tasks run on the caller alone afterwards
+ */
+void jobStop(void) {
+    int i;
+
+    pthread_mutex_lock( & s_sIdleLock);
+    s_bQuit = 1;
+    pthread_cond_broadcast( & s_sIdleWake);
+    pthread_mutex_unlock( & s_sIdleLock);
+
+    for (i = 1; i < s_nThreads; i++)
+        pthread_join(s_aThreads[i], NULL);
+
+    s_nThreads = 1;
+}
+
+/**
+ * Returns the number of threads running tasks, the caller included
+ */
+int jobThreads(void) {
+    return s_nThreads;
+}
+
+/**
+ * Returns the number of the calling thread in the pool, 0 for the thread
+ * that started it
+ */
+int jobSelf(void) {
+    return s_nSelf;
+}
+
+/**
+ * Adds a task to a group: items nFirst to nLast - 1 of a job, split in
+ * halves between threads down to nGrain items. Without a pool, or with a
+ * full deque, it runs at once.
+ *
+ * Parameters:
+ * pGroup		Group to add to
+ * pfnJob		Does a range of items
+ * pData		Passed to every range
+ * nFirst		First item
+ * nLast		Item after the last
+ * nGrain		Fewest items worth handing to another thread
+ */
+void jobSpawn(JOBGROUP * pGroup, JOBFUNC pfnJob, void * pData, int nFirst, int nLast, int nGrain) {
+    JOBTASK sTask;
+
+    if (nLast <= nFirst)
+        return;
+
+    sTask.pfn = pfnJob;
+    sTask.data = pData;
+    sTask.first = nFirst;
+    sTask.last = nLast;
+    sTask.grain = nGrain > 0 ? nGrain : 1;
+    sTask.group = pGroup;
+
+    __atomic_add_fetch( & pGroup -> pending, 1, __ATOMIC_ACQ_REL);
+    if (s_nThreads == 1 || jobPush(s_nSelf, & sTask) != 0)
+        jobExecute(s_nSelf, & sTask);
+}
+
+/**
+ * Waits for every task of a group, running tasks meanwhile
+ *
+ * Parameters:
+ * pGroup		Group to wait for
+ */
+void jobWait(JOBGROUP * pGroup) {
+    JOBTASK sTask;
+
+    while (__atomic_load_n( & pGroup -> pending, __ATOMIC_ACQUIRE) > 0) {
+        if (jobFind(s_nSelf, & sTask))
+            jobExecute(s_nSelf, & sTask);
+        else
+            sched_yield();
+    }
+}
+
+/**
+ * Runs every item of a job across the pool and waits for all of them
+ *
+ * Parameters:
+ * pfnJob		Does a range of items
+ * pData		Passed to every range
+ * nCount		Number of items
+ * nGrain		Fewest items worth handing to another thread, 0 to
+ *				split about eight ways per thread
+ */
+void jobFor(JOBFUNC pfnJob, void * pData, int nCount, int nGrain) {
+    JOBGROUP sGroup = { 0 };
+
+    if (nGrain < 1)
+        nGrain = nCount / (s_nThreads * 8);
+
+    jobSpawn( & sGroup, pfnJob, pData, 0, nCount, nGrain);
+    jobWait( & sGroup);
+}
+
+/**
+ * Sets the function called around every task, NULL for none. Set it while
+ * no jobs are running.
+ *
+ * Parameters:
+ * pfnHook		Timing hook
+ */
+void jobHook(JOBHOOK pfnHook) {
+    s_pfnHook = pfnHook;
+}
+
+/**
+ * Returns what one thread has done since the statistics were cleared
+ *
+ * Parameters:
+ * nThread		Thread in the pool
+ * pStats		Receives the statistics
+ */
+void jobStats(int nThread, JOBSTATS * pStats) {
+    * pStats = s_aDeques[nThread].stats;
+}
+
+/**
+ * Clears the statistics of every thread, while no jobs are running
+ */
+void jobClearStats(void) {
+    int i;
+
+    for (i = 0; i < JOB_MAX_THREADS; i++) {
+        s_aDeques[i].stats.tasks = 0;
+        s_aDeques[i].stats.splits = 0;
+        s_aDeques[i].stats.steals = 0;
+    }
+}
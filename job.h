@@ -0,0 +1,56 @@
+/**
+ * File:        job.h
+ * Purpose:     Header file for job.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _JOB_H_
+#define _JOB_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Most threads running jobs, the calling thread included
+#define JOB_MAX_THREADS 16
+
+// Tasks each thread can have waiting, a full deque runs new tasks at once
+#define JOB_DEQUE_SIZE 256
+
+// Work on the items nFirst to nLast - 1 of a job
+typedef void (* JOBFUNC)(void * pData, int nFirst, int nLast);
+
+// Called by the thread running a task before it starts and once it is done
+typedef void (* JOBHOOK)(int nThread, JOBFUNC pfnJob, int nFirst, int nLast, int bDone);
+
+// Tasks to wait for together, start with { 0 }
+typedef struct JOBGROUP
+{
+	int pending;
+} JOBGROUP;
+
+// What one thread has done
+typedef struct JOBSTATS
+{
+	long tasks;
+	long splits;
+	long steals;
+} JOBSTATS;
+
+// Function declarations
+int jobStart(int nThreads);
+void jobStop(void);
+int jobThreads(void);
+int jobSelf(void);
+void jobSpawn(JOBGROUP * pGroup, JOBFUNC pfnJob, void * pData, int nFirst, int nLast, int nGrain);
+void jobWait(JOBGROUP * pGroup);
+void jobFor(JOBFUNC pfnJob, void * pData, int nCount, int nGrain);
+void jobHook(JOBHOOK pfnHook);
+void jobStats(int nThread, JOBSTATS * pStats);
+void jobClearStats(void);
+
+#endif
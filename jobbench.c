@@ -0,0 +1,238 @@
+/**
+ * File:        jobbench.c
+ * Purpose:     Measures how the job system scales from one thread to many
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "job.h"
+
+// Defaults when no arguments are given
+#define DEFAULT_THREADS 4
+#define DEFAULT_ELEMENTS (1 << 20)
+
+// Rounds of hashing per element, sets how heavy the items are
+#define HASH_ROUNDS 64
+
+// Items below which the task tree stops splitting
+#define TREE_LEAF 256
+
+// Time spent in tasks by each thread, kept by the hook. Tasks run inside
+// a waiting task only count once, through the outermost one.
+static double s_aBusy[JOB_MAX_THREADS];
+static double s_aStarted[JOB_MAX_THREADS];
+static int s_aDepth[JOB_MAX_THREADS];
+
+/**
+ * Returns wall clock time in seconds
+ */
+static double benchNow(void) {
+    struct timeval tv;
+
+    gettimeofday( & tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/**
+ * Adds up the time each thread spends running tasks
+ *
+ * Parameters:
+ * nThread		Thread running the task
+ * pfnJob		Job of the task
+ * nFirst		First item
+ * nLast		Item after the last
+ * bDone		0 when it starts, 1 when it is done
+ */
+static void benchHook(int nThread, JOBFUNC pfnJob, int nFirst, int nLast, int bDone) {
+    (void) pfnJob;
+    (void) nFirst;
+    (void) nLast;
+
+    if (!bDone) {
+        if (s_aDepth[nThread]++ == 0)
+            s_aStarted[nThread] = benchNow();
+    } else if (--s_aDepth[nThread] == 0) {
+        s_aBusy[nThread] += benchNow() - s_aStarted[nThread];
+    }
+}
+
+/**
+ * Returns a hash of one element, slow enough to be worth sharing
+ *
+ * Parameters:
+ * n			Element
+ */
+static unsigned int benchHash(unsigned int n) {
+    int i;
+
+    for (i = 0; i < HASH_ROUNDS; i++)
+        n = (n ^ (n >> 15)) * 2246822519u + (unsigned int) i;
+
+    return n;
+}
+
+/**
+ * Hashes a range of elements into the output
+ *
+ * Parameters:
+ * pData		Output, one hash per element
+ * nFirst		First element
+ * nLast		Element after the last
+ */
+static void benchFor(void * pData, int nFirst, int nLast) {
+    unsigned int * pOut = (unsigned int * ) pData;
+    int i;
+
+    for (i = nFirst; i < nLast; i++)
+        pOut[i] = benchHash((unsigned int) i);
+}
+
+/**
+ * Hashes a range by splitting it in a tree of nested groups, the way a
+ * recursive subsystem would
+ *
+ * Parameters:
+ * pData		Output, one hash per element
+ * nFirst		First element
+ * nLast		Element after the last
+ */
+static void benchTree(void * pData, int nFirst, int nLast) {
+    JOBGROUP sGroup = { 0 };
+    int nMid;
+
+    if (nLast - nFirst <= TREE_LEAF) {
+        benchFor(pData, nFirst, nLast);
+        return;
+    }
+
+    // Each half is a task of its own that waits for its own halves
+    nMid = nFirst + (nLast - nFirst) / 2;
+    jobSpawn( & sGroup, benchTree, pData, nFirst, nMid, nMid - nFirst);
+    jobSpawn( & sGroup, benchTree, pData, nMid, nLast, nLast - nMid);
+    jobWait( & sGroup);
+}
+
+/**
+ * Returns a checksum of the output
+ *
+ * Parameters:
+ * pOut			Output
+ * nElements	Number of elements
+ */
+static unsigned int benchChecksum(const unsigned int * pOut, int nElements) {
+    unsigned int nHash = 2166136261u;
+    int i;
+
+    for (i = 0; i < nElements; i++)
+        nHash = (nHash ^ pOut[i]) * 16777619u;
+
+    return nHash;
+}
+
+/**
+ * Runs one workload on a number of threads and prints how it went.
+ * Returns the time it took.
+ *
+ * Parameters:
+ * pszName		Name of the workload
+ * bTree		Nonzero for the task tree, zero for the parallel for
+ * nThreads		Threads to use, the calling thread included
+ * pOut			Output
+ * nElements	Number of elements
+ * dBase		Time it took on one thread, 0 if not known yet
+ * pSum			Receives the checksum of the output
+ */
+static double benchRun(const char * pszName, int bTree, int nThreads, unsigned int * pOut, int nElements, double dBase, unsigned int * pSum) {
+    JOBSTATS sStats;
+    JOBGROUP sGroup = { 0 };
+    double dStart, dTime;
+    long nTasks = 0, nSteals = 0;
+    int i;
+
+    nThreads = jobStart(nThreads);
+    jobClearStats();
+    for (i = 0; i < JOB_MAX_THREADS; i++)
+        s_aBusy[i] = 0;
+
+    dStart = benchNow();
+    if (bTree) {
+        jobSpawn( & sGroup, benchTree, pOut, 0, nElements, nElements);
+        jobWait( & sGroup);
+    } else {
+        jobFor(benchFor, pOut, nElements, 0);
+    }
+    dTime = benchNow() - dStart;
+
+    * pSum = benchChecksum(pOut, nElements);
+
+    printf("%-5s %2d threads: %8.2f ms", pszName, nThreads, dTime * 1e3);
+    if (dBase > 0 && dTime > 0)
+        printf(", %5.2fx", dBase / dTime);
+
+    for (i = 0; i < nThreads; i++) {
+        jobStats(i, & sStats);
+        nTasks += sStats.tasks;
+        nSteals += sStats.steals;
+    }
+    printf(", %ld tasks, %ld steals, busy", nTasks, nSteals);
+    for (i = 0; i < nThreads; i++)
+        printf(" %.0f%%", dTime > 0 ? s_aBusy[i] * 100 / dTime : 0.0);
+    printf("\n");
+
+    jobStop();
+
+    return dTime;
+}
+
+/**
+ * Entry point for the job system benchmark
+ *
+ * Usage: jobbench [threads] [elements]
+ */
+int main(int argc, char * argv[]) {
+    int nMaxThreads = argc > 1 ? atoi(argv[1]) : DEFAULT_THREADS;
+    int nElements = argc > 2 ? atoi(argv[2]) : DEFAULT_ELEMENTS;
+    unsigned int * pOut;
+    unsigned int nSum, nBase = 0;
+    double dFor = 0, dTree = 0;
+    int bMatch = 1;
+    int n;
+
+    if (nMaxThreads < 1)
+        nMaxThreads = 1;
+    if (nMaxThreads > JOB_MAX_THREADS)
+        nMaxThreads = JOB_MAX_THREADS;
+    if (nElements < 1)
+        nElements = 1;
+
+    pOut = malloc(nElements * sizeof(unsigned int));
+    if (pOut == NULL)
+        return 1;
+
+    jobHook(benchHook);
+
+    printf("%d elements, %d rounds each\n", nElements, HASH_ROUNDS);
+    for (n = 1; n <= nMaxThreads; n++) {
+        if (n == 1) {
+            dFor = benchRun("for", 0, n, pOut, nElements, 0, & nBase);
+            dTree = benchRun("tree", 1, n, pOut, nElements, 0, & nSum);
+        } else {
+            benchRun("for", 0, n, pOut, nElements, dFor, & nSum);
+            bMatch &= nSum == nBase;
+            benchRun("tree", 1, n, pOut, nElements, dTree, & nSum);
+        }
+        bMatch &= nSum == nBase;
+    }
+    printf("results %s\n", bMatch ? "match" : "DIFFER");
+
+    jobHook(NULL);
+    free(pOut);
+
+    return !bMatch;
+}
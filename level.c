@@ -0,0 +1,503 @@
+/**
+ * File:        level.c
+ * Purpose:     Map data for the simulation, decoded straight from the FMP file
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "level.h"
+#include "collide.h"
+#include "nav.h"
+
+// Level being simulated
+SIM_LOCAL LEVEL * g_pLevel = NULL;
+
+/**
+ * Reads a big-endian chunk size
+ *
+ * Parameters:
+ * p			Bytes to read
+ */
+static long readChunkSize(const unsigned char * p) {
+    return ((long) p[0] << 24) | ((long) p[1] << 16) | ((long) p[2] << 8) | (long) p[3];
+}
+
+/**
+ * Reads a 16-bit value in the byte order of the map
+ *
+ * Parameters:
+ * p			Bytes to read
+ * bLsb			Whether the map is little-endian
+ */
+static int readShort(const unsigned char * p, int bLsb) {
+    int n = bLsb ? (p[0] | (p[1] << 8)) : ((p[0] << 8) | p[1]);
+
+    return (n & 0x8000) ? n - 0x10000 : n;
+}
+
+/**
+ * Reads a 32-bit value in the byte order of the map
+ *
+ * Parameters:
+ * p			Bytes to read
+ * bLsb			Whether the map is little-endian
+ */
+static long readLong(const unsigned char * p, int bLsb) {
+    if (bLsb)
+        return (long) p[0] | ((long) p[1] << 8) | ((long) p[2] << 16) | ((long) p[3] << 24);
+
+    return ((long) p[0] << 24) | ((long) p[1] << 16) | ((long) p[2] << 8) | (long) p[3];
+}
+
+/**
+ * Remembers a changed cell so the renderer can catch up
+ *
+ * Parameters:
+ * pLevel		Level the cell belongs to
+ * nCell		Index of the cell
+ */
+static void markDirty(LEVEL * pLevel, int nCell) {
+    if (pLevel -> ndirty < LEVEL_MAX_DIRTY)
+        pLevel -> dirty[pLevel -> ndirty++] = nCell;
+    else
+        pLevel -> alldirty = 1;
+}
+
+/**
+ * Loads the gameplay data of a Mappy FMP map: the header, the block
+ * properties and the first layer. Graphics are skipped. Returns NULL if
+ * the file cannot be read or uses an unsupported format.
+ *
+ * Parameters:
+ * szPath		Path to the map file
+ */
+LEVEL * levelLoad(const char * szPath) {
+    FILE * fp;
+    LEVEL * pLevel;
+    unsigned char aHeader[12];
+    unsigned char * pChunk = NULL;
+    long nChunk;
+    long nLeft;
+    int bLsb = 0;
+    int nType = 0;
+    int nStrSize = 0;
+    int i;
+    int nCell;
+
+    fp = fopen(szPath, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    pLevel = calloc(1, sizeof(LEVEL));
+    if (pLevel == NULL || fread(aHeader, 1, 12, fp) != 12 ||
+        memcmp(aHeader, "FORM", 4) || memcmp(aHeader + 8, "FMAP", 4))
+        goto fail;
+
+    // Walk the chunks
+    for (nLeft = readChunkSize(aHeader + 4) - 4; nLeft > 0; nLeft -= nChunk + 8) {
+        if (fread(aHeader, 1, 8, fp) != 8)
+            goto fail;
+
+        nChunk = readChunkSize(aHeader + 4);
+
+        // Skip what the simulation does not need, graphics mostly
+        if (memcmp(aHeader, "MPHD", 4) && memcmp(aHeader, "BKDT", 4) && memcmp(aHeader, "BODY", 4)) {
+            if (fseek(fp, nChunk, SEEK_CUR))
+                goto fail;
+            continue;
+        }
+
+        pChunk = malloc(nChunk);
+        if (pChunk == NULL || fread(pChunk, 1, nChunk, fp) != (size_t) nChunk)
+            goto fail;
+
+        if (!memcmp(aHeader, "MPHD", 4)) {
+            bLsb = pChunk[2] == 1;
+            nType = pChunk[3];
+            pLevel -> width = readShort(pChunk + 4, bLsb);
+            pLevel -> height = readShort(pChunk + 6, bLsb);
+            nStrSize = readShort(pChunk + 18, bLsb);
+            pLevel -> nblocks = readShort(pChunk + 20, bLsb);
+
+            // Compressed layers are not supported
+            if (nType > 1 || nStrSize < 32)
+                goto fail;
+        } else if (!memcmp(aHeader, "BKDT", 4)) {
+            pLevel -> blocks = calloc(pLevel -> nblocks, sizeof(LEVELBLK));
+            if (pLevel -> blocks == NULL || nChunk < (long) pLevel -> nblocks * nStrSize)
+                goto fail;
+
+            for (i = 0; i < pLevel -> nblocks; i++) {
+                pLevel -> blocks[i].value = readLong(pChunk + i * nStrSize + 16, bLsb);
+                pLevel -> blocks[i].spawn = pChunk[i * nStrSize + 28];
+                pLevel -> blocks[i].flags = pChunk[i * nStrSize + 31];
+            }
+        } else {
+            nCell = pLevel -> width * pLevel -> height;
+            pLevel -> cells = malloc(nCell * sizeof(short));
+            pLevel -> pristine = malloc(nCell * sizeof(short));
+            if (pLevel -> cells == NULL || pLevel -> pristine == NULL || nChunk < nCell * 2)
+                goto fail;
+
+            for (i = 0; i < nCell; i++) {
+                pLevel -> cells[i] = readShort(pChunk + i * 2, bLsb);
+
+                // Older maps store byte offsets into the block data
+                if (nType == 0 && pLevel -> cells[i] > 0)
+                    pLevel -> cells[i] /= nStrSize;
+
+                // Animated cells do not take part in the game
+                if (pLevel -> cells[i] < 0 || pLevel -> cells[i] >= pLevel -> nblocks)
+                    pLevel -> cells[i] = 0;
+            }
+
+            memcpy(pLevel -> pristine, pLevel -> cells, nCell * sizeof(short));
+        }
+
+        free(pChunk);
+        pChunk = NULL;
+    }
+
+    fclose(fp);
+
+    if (pLevel -> blocks == NULL || pLevel -> cells == NULL) {
+        levelFree(pLevel);
+        return NULL;
+    }
+
+    return pLevel;
+
+fail:
+    free(pChunk);
+    fclose(fp);
+    levelFree(pLevel);
+    return NULL;
+}
+
+/**
+ * Makes a level of its own cells that borrows the blocks and pristine
+ * cells of a loaded one, for games played side by side on the same map.
+ * The source has to outlive it. Returns NULL if out of memory.
+ *
+ * Parameters:
+ * pSource		Loaded level
+ */
+LEVEL * levelShare(LEVEL * pSource) {
+    LEVEL * pLevel;
+    int nCell = pSource -> width * pSource -> height;
+
+    pLevel = calloc(1, sizeof(LEVEL));
+    if (pLevel == NULL)
+        return NULL;
+
+    pLevel -> width = pSource -> width;
+    pLevel -> height = pSource -> height;
+    pLevel -> nblocks = pSource -> nblocks;
+    pLevel -> blocks = pSource -> blocks;
+    pLevel -> pristine = pSource -> pristine;
+    pLevel -> source = pSource;
+
+    pLevel -> cells = malloc(nCell * sizeof(short));
+    if (pLevel -> cells == NULL) {
+        free(pLevel);
+        return NULL;
+    }
+    memcpy(pLevel -> cells, pSource -> pristine, nCell * sizeof(short));
+
+    return pLevel;
+}
+
+/**
+ * Frees a level, borrowed data stays with its source
+ *
+ * Parameters:
+ * pLevel		Level to free
+ */
+void levelFree(LEVEL * pLevel) {
+    if (pLevel == NULL)
+        return;
+
+    if (pLevel -> source == NULL) {
+        free(pLevel -> blocks);
+        free(pLevel -> pristine);
+    }
+    free(pLevel -> cells);
+    free(pLevel);
+
+    if (g_pLevel == pLevel)
+        g_pLevel = NULL;
+}
+
+/**
+ * Checks whether a block may be put in a cell of the current level. A
+ * level made by levelShare shares the collision plane and platform graph
+ * of its source with other games, so its cells keep the solidity and
+ * spikes of the pristine map.
+ *
+ * Parameters:
+ * nCell		Index of the cell
+ * nBlock		Block to put there
+ */
+static int levelCanSet(int nCell, int nBlock) {
+    if (g_pLevel -> source == NULL)
+        return 1;
+
+    return ((g_pLevel -> blocks[g_pLevel -> pristine[nCell]].flags ^ g_pLevel -> blocks[nBlock].flags) & (BLK_SOLID | BLK_SPIKE)) == 0;
+}
+
+/**
+ * Puts a cell of the current level back in the collision plane and the
+ * platform graph after it changed. Blocks of the same solidity and spikes
+ * leave both untouched, so games sharing them can take gems.
+ *
+ * Parameters:
+ * nCell		Index of the cell
+ * nOld			Block the cell held before
+ */
+static void levelRefresh(int nCell, int nOld) {
+    int tx = nCell % g_pLevel -> width;
+    int ty = nCell / g_pLevel -> width;
+    int nChanged = g_pLevel -> blocks[nOld].flags ^ g_pLevel -> blocks[g_pLevel -> cells[nCell]].flags;
+
+    if ((nChanged & (BLK_SOLID | BLK_SPIKE)) == 0)
+        return;
+
+    // Spikes only mark segments and links as hazards
+    if (collisionRefresh(tx, ty) || (nChanged & BLK_SPIKE))
+        navPatch(tx, ty);
+}
+
+/**
+ * Puts back every cell of the current level changed since loading,
+ * marking them dirty
+ */
+void levelRestore(void) {
+    int i;
+    int nOld;
+
+    for (i = 0; i < g_pLevel -> width * g_pLevel -> height; i++) {
+        if (g_pLevel -> cells[i] == g_pLevel -> pristine[i])
+            continue;
+
+        nOld = g_pLevel -> cells[i];
+        g_pLevel -> cells[i] = g_pLevel -> pristine[i];
+        markDirty(g_pLevel, i);
+        levelRefresh(i, nOld);
+    }
+}
+
+/**
+ * Returns the block of a cell of the current level
+ *
+ * Parameters:
+ * tx			Tile column
+ * ty			Tile row
+ */
+LEVELBLK * levelGetBlock(int tx, int ty) {
+    return & g_pLevel -> blocks[g_pLevel -> cells[ty * g_pLevel -> width + tx]];
+}
+
+/**
+ * Changes a cell of the current level and keeps the derived collision
+ * data in sync. Returns -1 without changing anything if the level is
+ * shared and the new block is solid or spiked where the map was not, or
+ * the other way round.
+ *
+ * Parameters:
+ * tx			Tile column
+ * ty			Tile row
+ * block		New block index
+ */
+int levelSetBlock(int tx, int ty, int block) {
+    int nCell = ty * g_pLevel -> width + tx;
+    int nOld = g_pLevel -> cells[nCell];
+
+    if (!levelCanSet(nCell, block))
+        return -1;
+
+    g_pLevel -> cells[nCell] = block;
+    markDirty(g_pLevel, nCell);
+    levelRefresh(nCell, nOld);
+
+    return 0;
+}
+
+/**
+ * Checks for a collision on the map at given screen coordinates
+ *
+ * Parameters:
+ * x			X coordinate
+ * y			Y coordinate
+ */
+int mapCollision(int x, int y) {
+    // Test the packed collision plane rather than the tile itself
+    return collisionSolid(x, y);
+}
+
+/**
+ * Checks for the presence of spikes on the map at given screen coordinates
+ *
+ * Parameters:
+ * x			X coordinate
+ * y			Y coordinate
+ */
+int spikeCheck(int x, int y) {
+    if (x < 0 || y < 0 || x >= g_pLevel -> width * TILE_SIZE || y >= g_pLevel -> height * TILE_SIZE)
+        return 0;
+
+    return (levelGetBlock(x / TILE_SIZE, y / TILE_SIZE) -> flags & BLK_SPIKE) != 0;
+}
+
+/**
+ * Returns the first cell of the current level from the given one on that
+ * differs from the pristine map, or the number of cells if none does.
+ * Unchanged stretches are skipped a block of cells at a time.
+ *
+ * Parameters:
+ * i			Cell to start at
+ */
+static int levelNextChanged(int i) {
+    int nCells = g_pLevel -> width * g_pLevel -> height;
+
+    while (i < nCells) {
+        if ((i & (LEVEL_SCAN_CELLS - 1)) == 0 && i + LEVEL_SCAN_CELLS <= nCells &&
+            !memcmp(g_pLevel -> cells + i, g_pLevel -> pristine + i, LEVEL_SCAN_CELLS * sizeof(short))) {
+            i += LEVEL_SCAN_CELLS;
+            continue;
+        }
+
+        if (g_pLevel -> cells[i] != g_pLevel -> pristine[i])
+            return i;
+        i++;
+    }
+
+    return nCells;
+}
+
+/**
+ * Packs the cells of the current level into a buffer, either all of them
+ * or only those that differ from the pristine map, as a count followed by
+ * the cell indices in order and their blocks. Returns the size of the
+ * packed cells, writing nothing if the buffer is NULL.
+ *
+ * Parameters:
+ * p			Buffer to pack into, or NULL to measure
+ * bDelta		Whether to pack only the changed cells
+ */
+size_t levelPack(unsigned char * p, int bDelta) {
+    int nCells = g_pLevel -> width * g_pLevel -> height;
+    int nChanged = 0;
+    short nBlock;
+    int i, k;
+
+    if (!bDelta) {
+        if (p != NULL)
+            memcpy(p, g_pLevel -> cells, nCells * sizeof(short));
+        return nCells * sizeof(short);
+    }
+
+    for (i = levelNextChanged(0); i < nCells; i = levelNextChanged(i + 1))
+        nChanged++;
+
+    if (p != NULL) {
+        memcpy(p, & nChanged, sizeof(int));
+
+        for (i = levelNextChanged(0), k = 0; i < nCells; i = levelNextChanged(i + 1), k++) {
+            nBlock = g_pLevel -> cells[i];
+            memcpy(p + sizeof(int) + k * sizeof(int), & i, sizeof(int));
+            memcpy(p + sizeof(int) + nChanged * sizeof(int) + k * sizeof(short), & nBlock, sizeof(short));
+        }
+    }
+
+    return sizeof(int) + nChanged * (sizeof(int) + sizeof(short));
+}
+
+/**
+ * Restores cells packed by levelPack into the current level. Only cells
+ * that differ are written, marked dirty and refreshed in the derived
+ * data. Returns the number of bytes read, 0 if the cells are out of order
+ * or off the map.
+ *
+ * Parameters:
+ * p			Packed cells
+ * bDelta		Whether only the changed cells were packed
+ */
+size_t levelUnpack(const unsigned char * p, int bDelta) {
+    int nCells = g_pLevel -> width * g_pLevel -> height;
+    const unsigned char * pIndices = p + sizeof(int);
+    const unsigned char * pBlocks;
+    int nChanged;
+    int nCell = -1;
+    int nLast = -1;
+    short nBlock;
+    int i, k;
+
+    if (!bDelta) {
+        for (i = 0; i < nCells; i++) {
+            memcpy( & nBlock, p + i * sizeof(short), sizeof(short));
+            if (nBlock < 0 || nBlock >= g_pLevel -> nblocks || !levelCanSet(i, nBlock))
+                return 0;
+        }
+
+        for (i = 0; i < nCells; i++) {
+            memcpy( & nBlock, p + i * sizeof(short), sizeof(short));
+            if (g_pLevel -> cells[i] != nBlock)
+                levelSetBlock(i % g_pLevel -> width, i / g_pLevel -> width, nBlock);
+        }
+
+        return nCells * sizeof(short);
+    }
+
+    memcpy( & nChanged, p, sizeof(int));
+    if (nChanged < 0 || nChanged > nCells)
+        return 0;
+    pBlocks = pIndices + nChanged * sizeof(int);
+
+    // Changed cells come in order and name real blocks that may go there
+    for (k = 0; k < nChanged; k++) {
+        memcpy( & nCell, pIndices + k * sizeof(int), sizeof(int));
+        memcpy( & nBlock, pBlocks + k * sizeof(short), sizeof(short));
+        if (nCell <= nLast || nCell >= nCells || nBlock < 0 || nBlock >= g_pLevel -> nblocks || !levelCanSet(nCell, nBlock))
+            return 0;
+        nLast = nCell;
+    }
+
+    // Cells changed now but not in the snapshot go back to pristine
+    nCell = -1;
+    for (i = levelNextChanged(0), k = 0; i < nCells; i = levelNextChanged(i + 1)) {
+        while (nCell < i && k < nChanged)
+            memcpy( & nCell, pIndices + k++ * sizeof(int), sizeof(int));
+
+        if (nCell != i)
+            levelSetBlock(i % g_pLevel -> width, i / g_pLevel -> width, g_pLevel -> pristine[i]);
+    }
+
+    // Then the cells of the snapshot
+    for (k = 0; k < nChanged; k++) {
+        memcpy( & nCell, pIndices + k * sizeof(int), sizeof(int));
+        memcpy( & nBlock, pBlocks + k * sizeof(short), sizeof(short));
+        if (g_pLevel -> cells[nCell] != nBlock)
+            levelSetBlock(nCell % g_pLevel -> width, nCell / g_pLevel -> width, nBlock);
+    }
+
+    return sizeof(int) + nChanged * (sizeof(int) + sizeof(short));
+}
+
+/**
+ * Lists the variables holding the level of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int levelState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, g_pLevel);
+
+    return n;
+}
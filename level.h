@@ -0,0 +1,83 @@
+/**
+ * File:        level.h
+ * Purpose:     Header file for level.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _LEVEL_H_
+#define _LEVEL_H_
+
+// Include C stdlib
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "state.h"
+
+// Size of a map tile in pixels
+#define TILE_SIZE 32
+
+// Block flags, laid out like the collision byte of a Mappy block
+#define BLK_TL 0x01
+#define BLK_TR 0x02
+#define BLK_BL 0x04
+#define BLK_BR 0x08
+#define BLK_TRIGGER 0x10
+#define BLK_SPIKE 0x20
+#define BLK_GOAL 0x40
+#define BLK_GEM 0x80
+
+// Most cells changed in a single tick
+#define LEVEL_MAX_DIRTY 64
+
+// Cells compared at a time when looking for changes, a power of two
+#define LEVEL_SCAN_CELLS 64
+
+// Gameplay view of a Mappy block, spawn is the actor kind a spawner block
+// places (user5 in Mappy), 0 for none
+typedef struct LEVELBLK
+{
+	unsigned char flags;
+	unsigned char spawn;
+	long value;
+} LEVELBLK;
+
+// Solid parts of a block
+#define BLK_SOLID (BLK_TL | BLK_TR | BLK_BL | BLK_BR)
+
+// Decoded map, without any graphics. A level made by levelShare borrows
+// the blocks and pristine cells of its source.
+typedef struct LEVEL
+{
+	int width, height;
+	int nblocks;
+	LEVELBLK * blocks;
+	short * cells;
+	short * pristine;
+	struct LEVEL * source;
+	int ndirty;
+	int alldirty;
+	int dirty[LEVEL_MAX_DIRTY];
+} LEVEL;
+
+// Level being simulated
+extern SIM_LOCAL LEVEL * g_pLevel;
+
+// Function declarations
+LEVEL * levelLoad(const char * szPath);
+LEVEL * levelShare(LEVEL * pSource);
+void levelFree(LEVEL * pLevel);
+void levelRestore(void);
+LEVELBLK * levelGetBlock(int tx, int ty);
+int levelSetBlock(int tx, int ty, int block);
+int mapCollision(int x, int y);
+int spikeCheck(int x, int y);
+size_t levelPack(unsigned char * p, int bDelta);
+size_t levelUnpack(const unsigned char * p, int bDelta);
+int levelState(STATEVAR * pVars);
+
+#endif
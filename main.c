@@ -12,434 +12,418 @@
 // Display buffer
 BITMAP * g_bBuffer;
 
-// Actor sprites
-SPRITE * g_sActors[NUM_ACTORS];
-int g_nActors = NUM_ACTORS;
-SPRITE * g_sPlayer;
+// Animation frames of each kind of actor
+BITMAP * g_bFrames[NUM_KINDS][MAX_FRAMES];
 
 // Sound samples
 SAMPLE * g_sJump;
 SAMPLE * g_sDie;
 SAMPLE * g_sWin;
 
-// Current player information
-int g_nPlayerScore = 0;
+// Best score so far
 int g_nHighScore = 0;
-int g_bVictory = 0;
-int g_nTimeLeft = 90;
 
-// Map information
-int g_nMapX = 0;
-int g_nMapY = 0;
+// Points of the last gem taken, shown by the score for a while
+int g_nGemValue = 0;
+int g_nGemTicks = 0;
 
-// Data file reference
-DATAFILE * g_dData;
+// Input being recorded, or being played back
+REPLAY * g_pRecording = NULL;
+REPLAY * g_pPlayback = NULL;
+long g_nPlaybackTick = 0;
 
-// Whether busy exiting
-int g_bExiting = 0;
+// Recent ticks to rewind through, and the tick the game is at
+REWIND * g_pRewind = NULL;
+long g_nTick = 0;
 
-// Mutex
-pthread_mutex_t threadsafe = PTHREAD_MUTEX_INITIALIZER;
+// Two-player game against a peer, and the slot of the player on this side
+NETLINK * g_pLink = NULL;
+ROLLBACK * g_pRollback = NULL;
+int g_nLocal = PLAYER;
+
+// Map layer as loaded, to put back cells the simulation restores
+short * g_pMapCells = NULL;
+
+// Data file reference
+DATAFILE * g_dData;
 
 // Display state
 int g_nMode = MODE_INTRO;
 
+// Tells the render thread to finish
+volatile int g_bDrawStop = 0;
+
+// Pacing of the simulation loop and of the render thread
+PACER g_sTickPacer;
+PACER g_sDrawPacer;
+
+// Key changes as they happen, and the buttons the game loop has taken
+INPUTQUEUE g_sInputQueue;
+INPUTSTATE g_sInput;
+
 /**
- * Checks for a collision with interactable objects on the map at given screen coordinates
+ * Queues a key change with the time it happened. Allegro calls it from
+ * its own input thread as keys go down and up, so changes are seen when
+ * they happen rather than when the game loop next looks.
  *
  * Parameters:
- * x			X coordinate
- * y			Y coordinate
+ * nScancode	Key, with the top bit set when it comes up
  */
-int objectCheck(int x, int y) {
-    // Fine the tile
-    BLKSTR * bBlkData;
-    bBlkData = MapGetBlock(x / 32, y / 32);
-
-    if (bBlkData -> unused2) // End of game
-    {
-        // Add score
-        g_nPlayerScore += 150;
-
-        // No longer alive, but victory
-        g_sPlayer -> alive = 0;
-        g_bVictory = 1;
-
-        play_sample(g_sWin, 250, 128, 1000, 0);
-
-        return 2;
+void keyHandler(int nScancode) {
+    int nButtons;
+
+    switch (nScancode & 0x7f) {
+    case KEY_LEFT:
+    case KEY_A:
+        nButtons = INPUT_LEFT;
+        break;
+    case KEY_RIGHT:
+    case KEY_D:
+        nButtons = INPUT_RIGHT;
+        break;
+    case KEY_UP:
+    case KEY_W:
+        nButtons = INPUT_JUMP;
+        break;
+    case KEY_ENTER:
+    case KEY_SPACE:
+        nButtons = INPUT_RESTART;
+        break;
+    case KEY_BACKSPACE:
+        nButtons = BUTTON_REWIND;
+        break;
+    case KEY_LCONTROL:
+    case KEY_RCONTROL:
+        nButtons = BUTTON_CTRL;
+        break;
+    case KEY_H:
+        nButtons = BUTTON_HELP;
+        break;
+    case KEY_M:
+        nButtons = BUTTON_MUSIC;
+        break;
+    default:
+        return;
     }
 
-    if (bBlkData -> unused3) // Gem pickup
-    {
-        // Add score
-        g_nPlayerScore += bBlkData -> user1;
-
-        // Set taken
-        MapSetBlock(x / 32, y / 32, 0);
-        return 1;
-    } else {
-        return 0;
-    }
+    inputPush( & g_sInputQueue, paceNow(), nButtons, !(nScancode & 0x80));
 }
+END_OF_FUNCTION(keyHandler)
 
-void plantReset(int index) {
-    g_sActors[index] -> player = 0;
-    g_sActors[index] -> frame = 0;
-    g_sActors[index] -> framecount = 0;
-    g_sActors[index] -> framedelay = 13;
-    g_sActors[index] -> maxframe = 2;
-    g_sActors[index] -> alive = 1;
-    g_sActors[index] -> w = g_sActors[index] -> bitmaps[0] -> w;
-    g_sActors[index] -> h = g_sActors[index] -> bitmaps[0] -> h;
-
-    g_sActors[index] -> jump = JUMPIT;
-    g_sActors[index] -> y = 100;
-    g_sActors[index] -> dir = 0;
-
-    g_sPlayer -> active = 0;
+/**
+ * Returns the score of the player on this side
+ */
+int localScore() {
+    return g_nLocal == RIVAL ? g_nRivalScore : g_nPlayerScore;
 }
 
 /**
- * Resets the player state to start a new game
+ * Saves the score as the high score if it was beaten
  */
-void playerReset() {
+void updateHighScore() {
     FILE * fp; // Pointer to score file
 
-    g_sPlayer -> player = 1;
-    g_sPlayer -> frame = 0;
-    g_sPlayer -> framecount = 0;
-    g_sPlayer -> framedelay = 5;
-    g_sPlayer -> maxframe = 7;
-    g_sPlayer -> alive = 1;
-    g_sPlayer -> w = g_sPlayer -> bitmaps[0] -> w;
-    g_sPlayer -> h = g_sPlayer -> bitmaps[0] -> h;
-
-    // Position the player
-    g_sPlayer -> x = g_sPlayer -> w;
-    g_sPlayer -> y = 100;
-    g_sPlayer -> jump = JUMPIT;
-
-    g_sPlayer -> active = 1;
-
-    g_bVictory = 0;
-
-    // Update high score and reset score
-    if (g_nPlayerScore > g_nHighScore) {
-        g_nHighScore = g_nPlayerScore > g_nHighScore ? g_nPlayerScore : g_nHighScore;
-        // Save high score to file
-        fp = fopen("score.dat", "w+");
-        if (fp != NULL) {
-            fprintf(fp, "%d", g_nHighScore);
-            fclose(fp);
-        }
-    }
+    if (localScore() <= g_nHighScore)
+        return;
+
+    g_nHighScore = localScore();
 
-    // Reset score
-    g_nPlayerScore = 0;
-    g_nTimeLeft = 90;
-
-    // Reset the plants
-    plantReset(1);
-    plantReset(2);
-    plantReset(3);
-    plantReset(4);
-
-    // Position the plants
-    g_sActors[1] -> x = g_sActors[1] -> w * 10;
-    g_sActors[2] -> x = g_sActors[2] -> w * 52;
-    g_sActors[3] -> x = g_sActors[3] -> w * 41;
-    g_sActors[3] -> y = 700;
-    g_sActors[4] -> x = g_sActors[4] -> w * 60;
+    // Save high score to file
+    fp = fopen("score.dat", "w+");
+    if (fp != NULL) {
+        fprintf(fp, "%d", g_nHighScore);
+        fclose(fp);
+    }
 }
 
 /**
- * Moves the actors on the screen, according to rules and physics
+ * Hands the events of the last tick to sound, the display and the high
+ * score, after the tick rather than in the middle of it
  */
-void moveActors() {
+void drainEvents() {
+    EVENT * pEvent;
     int i;
 
-    for (i = 0; i < g_nActors; i++) {
-        // Only accept movements if alive
-        if (g_sActors[i] -> alive) {
-            // Loop through frames in the animation
-            if (g_sActors[i] -> moving) {
-                if (++g_sActors[i] -> framecount > g_sActors[i] -> framedelay) {
-                    g_sActors[i] -> framecount = 0;
-                    if (++g_sActors[i] -> frame > g_sActors[i] -> maxframe)
-                        g_sActors[i] -> frame = 1;
-                }
-            }
+    for (i = 0; i < g_sEvents.count; i++) {
+        pEvent = & g_sEvents.events[i];
 
-            // Only player picks up gems		
-            if (g_sActors[i] -> player)
-                objectCheck(g_sActors[i] -> x + g_sActors[i] -> w / 2, g_sActors[i] -> y + g_sActors[i] -> h); // Take any gems
+        switch (pEvent -> type) {
+        case EVENT_JUMP:
+            play_sample(g_sJump, 250, 128, 1000, 0);
+            break;
+        case EVENT_GEM:
+            g_nGemValue = pEvent -> value;
+            g_nGemTicks = TICK_RATE;
+            break;
+        case EVENT_DEATH:
+        case EVENT_TIMEUP:
+            play_sample(g_sDie, 250, 128, 1000, 0);
+            updateHighScore();
+            break;
+        case EVENT_VICTORY:
+            play_sample(g_sWin, 250, 128, 1000, 0);
+            updateHighScore();
+            break;
         }
+    }
+}
 
-        // Player is falling, not jumping
-        if (g_sActors[i] -> jump == JUMPIT) {
-            // Check for solid blocks
-            if (!mapCollision(g_sActors[i] -> x + g_sActors[i] -> w / 2, g_sActors[i] -> y + g_sActors[i] -> h)) {
-                g_sActors[i] -> jump = 0;
-                if (spikeCheck(g_sActors[i] -> x + g_sActors[i] -> w / 2, g_sActors[i] -> y + g_sActors[i] -> h)) // Kill actor if hitting a spike
-                {
-                    // Only play sound once
-                    if (g_sActors[i] -> alive && g_sActors[i] -> player) {
-                        play_sample(g_sDie, 250, 128, 1000, 0);
-                    }
-                    g_sActors[i] -> alive = 0;
-                }
-            }
+/**
+ * Hands the cells the simulation changed to the renderer, as the Mappy
+ * layer should show them
+ */
+void syncMap() {
+    int i;
+    int nCell;
 
-            // Actor wants to jump (only for player)
-            if (i == 0 && g_sActors[i] -> alive && g_sActors[i] -> jumpqueued) {
-                g_sActors[i] -> jump = 32;
-                play_sample(g_sJump, 250, 128, 1000, 0);
-            }
-        } else {
-            // Actor is jumping
-            g_sActors[i] -> y -= g_sActors[i] -> jump / 3;
-            g_sActors[i] -> jump--;
+    if (g_pLevel -> alldirty) {
+        // Too many changes were tracked, send the whole layer
+        for (nCell = 0; nCell < g_pLevel -> width * g_pLevel -> height; nCell++) {
+            renderCell(nCell,
+                g_pLevel -> cells[nCell] == g_pLevel -> pristine[nCell] ? g_pMapCells[nCell] : g_pLevel -> cells[nCell]);
         }
-
-        // End of jump
-        if (g_sActors[i] -> jump < 0) {
-            if (mapCollision(g_sActors[i] -> x + g_sActors[i] -> w / 2, g_sActors[i] -> y + g_sActors[i] -> h)) {
-                g_sActors[i] -> jump = JUMPIT;
-                while (mapCollision(g_sActors[i] -> x + g_sActors[i] -> w / 2, g_sActors[i] -> y + g_sActors[i] -> h))
-                    g_sActors[i] -> y -= 2;
-            }
+    } else {
+        for (i = 0; i < g_pLevel -> ndirty; i++) {
+            nCell = g_pLevel -> dirty[i];
+            renderCell(nCell,
+                g_pLevel -> cells[nCell] == g_pLevel -> pristine[nCell] ? g_pMapCells[nCell] : g_pLevel -> cells[nCell]);
         }
+    }
 
-        if (!g_sActors[i] -> dir) { // Check collision on left edge of sprite
-            if (mapCollision(g_sActors[i] -> x, g_sActors[i] -> y + g_sActors[i] -> h)) {
-                g_sActors[i] -> x = g_sActors[i] -> oldx;
-                if (!g_sActors[i] -> player)
-                    g_sActors[i] -> dir = 1;
-            }
-        } else { // Check collision on right edge of sprite
-            if (mapCollision(g_sActors[i] -> x + g_sActors[i] -> w, g_sActors[i] -> y + g_sActors[i] -> h)) {
-                g_sActors[i] -> x = g_sActors[i] -> oldx;
-                if (!g_sActors[i] -> player)
-                    g_sActors[i] -> dir = 0;
-            }
-        }
+    g_pLevel -> ndirty = 0;
+    g_pLevel -> alldirty = 0;
+}
 
-        // Check collisions with edges
-        if (g_sActors[i] -> x < 0) {
-            g_sActors[i] -> x = 0;
-            if (!g_sActors[i] -> player)
-                g_sActors[i] -> dir = 1;
-        } else if (g_sActors[i] -> x > (MAP_WIDTH - 1) * 32) {
-            g_sActors[i] -> x = (MAP_WIDTH - 1) * 32;
-            if (!g_sActors[i] -> player)
-                g_sActors[i] -> dir = 0;
-        }
+/**
+ * Plays the next tick of a game against a peer, after exchanging inputs
+ * with it. The tick may have to wait for the peer, or play earlier ticks
+ * again first.
+ *
+ * Parameters:
+ * nInput		INPUT_* buttons of the player on this side
+ */
+void netplayTick(int nInput) {
+    unsigned char aPacket[NET_PACKET_MAX];
+    int nSize;
+    int nResult;
 
-        // Check player collisions
-        if (i != 0 && g_sActors[i] -> alive) {
-            if (abs(g_sActors[i] -> y - g_sActors[0] -> y) < g_sActors[i] -> h / 2) // Vertical collision
-            {
-                if (abs(g_sActors[i] -> x - g_sActors[0] -> x) < g_sActors[i] -> w / 2) // Horizontal collision
-                {
-                    // Kill player
-                    if (g_sActors[0] -> alive) {
-                        play_sample(g_sDie, 250, 128, 1000, 0);
-                        g_sActors[0] -> alive = 0;
-                        g_sActors[0] -> jump = JUMPIT;
-                    }
-                }
-            }
-        }
+    while ((nSize = netRecv(g_pLink, aPacket, sizeof(aPacket))) > 0)
+        rollbackReceive(g_pRollback, aPacket, nSize);
 
-        if (g_sActors[i] -> y > 740) {
-            // Only play sound once, only for player
-            if (g_sActors[i] -> alive && g_sActors[i] -> player)
-                play_sample(g_sDie, 250, 128, 1000, 0);
+    nResult = rollbackAdvance(g_pRollback, nInput);
+    if (nResult < 0)
+        fprintf(stderr, "Netplay lost the state to roll back to at tick %ld\n", g_pRollback -> frame);
 
-            // Actor is dead
-            g_sActors[i] -> alive = 0;
-            g_sActors[i] -> jump = JUMPIT;
-        } else if (g_sActors[i] -> y < -g_sActors[i] -> h) {
-            g_sActors[i] -> y = -g_sActors[i] -> h;
-        }
-    }
-}
+    nSize = rollbackPacket(g_pRollback, aPacket, ROLLBACK_PACKET_MAX);
+    netSend(g_pLink, aPacket, nSize);
+
+    if (nResult <= 0)
+        return;
+
+    g_nTick = g_pRollback -> frame;
 
-inline int actorVisible(int i) {
-    return g_sActors[i] -> x - g_nMapX > -g_sActors[i] -> w && g_sActors[i] -> x - g_nMapX < SCREEN_W + g_sActors[i] -> w &&
-        g_sActors[i] -> y - g_nMapY > -g_sActors[i] -> h && g_sActors[i] -> y - g_nMapY < SCREEN_H + g_sActors[i] -> h;
+    // Events of ticks played again are not raised a second time
+    if (g_nGemTicks > 0)
+        g_nGemTicks--;
+    drainEvents();
 }
 
 /**
- * Decides on AI movement for NPCs
+ * Performs one fixed-length simulation tick while the game is ongoing
+ *
+ * Parameters:
+ * nButtons		INPUT_* and BUTTON_* buttons of the tick
  */
-void aiMovement() {
-    int i;
-    int tmpY;
-    int unsafe;
-
-    for (i = 1; i < g_nActors; i++) {
-        // Check if seen
-        if ((!g_sActors[i] -> active) && actorVisible(i))
-            g_sActors[i] -> active = 1;
-
-        // Don't move if jumping or never seen
-        if (g_sActors[i] -> jump == 0 && g_sActors[i] -> active) {
-            // Move in current direction
-            g_sActors[i] -> moving = 1;
-            if (g_sActors[i] -> dir) {
-                g_sActors[i] -> x += 5;
-            } else {
-                g_sActors[i] -> x -= 5;
-            }
-        }
-
-        // Check for dangers
-        tmpY = g_sActors[i] -> y;
-        unsafe = 0;
-
-        // Simulate a fall
-        while (!mapCollision(g_sActors[i] -> x + g_sActors[i] -> w / 2, tmpY + g_sActors[i] -> h)) {
-            tmpY += 2;
-            if (tmpY > 730) // Check for falling off map
-            {
-                unsafe = 1;
-                break;
-            }
-
-            if (spikeCheck(g_sActors[i] -> x + g_sActors[i] -> w / 2, tmpY + g_sActors[i] -> h)) // Check for spikes
-            {
-                unsafe = 1;
-            }
+void gameTick(int nButtons) {
+    int nInput = nButtons & (INPUT_LEFT | INPUT_RIGHT | INPUT_JUMP | INPUT_RESTART); // Buttons held this tick
+
+    // Holding Backspace goes back a tick at a time, the clock with it
+    if (g_pRewind != NULL && (nButtons & BUTTON_REWIND)) {
+        if (g_nTick > rewindOldest(g_pRewind) && rewindSeek(g_pRewind, g_nTick - 1) == 0) {
+            g_nTick--;
+            if (g_pRecording != NULL)
+                g_pRecording -> nticks = g_nTick;
         }
+        return;
+    }
 
-        // If unsafe, reverse direction
-        if (unsafe) {
-            if (g_sActors[i] -> dir) {
-                g_sActors[i] -> dir = 0;
-                g_sActors[i] -> x -= 10;
-            } else {
-                g_sActors[i] -> dir = 1;
-                g_sActors[i] -> x += 10;
-            }
-        }
+    if (g_pRollback != NULL) {
+        netplayTick(nInput);
+        return;
     }
-}
 
-/**
- * Performs one step in the game loop while the game is ongoing
- */
-void gameStep() {
-    // Iterator
-    int i;
+    // Replays ignore the keyboard
+    if (g_pPlayback != NULL)
+        nInput = g_pPlayback -> inputs[g_nPlaybackTick];
 
-    // Keep track of current state
-    g_sPlayer -> moving = 0;
-    g_sPlayer -> jumpqueued = 0;
+    simTick(nInput);
+    g_nTick++;
 
-    // Update old locations
-    for (i = 0; i < g_nActors; i++) {
-        g_sActors[i] -> oldx = g_sActors[i] -> x;
-        g_sActors[i] -> oldy = g_sActors[i] -> y;
-    }
+    // Going on after a rewind forgets the ticks that were rewound
+    if (g_pRewind != NULL)
+        rewindPush(g_pRewind, g_nTick);
 
-    // Only accept movements if player is alive
-    if (g_sPlayer -> alive) {
-        if (key[KEY_LEFT] || key[KEY_A]) // Go left
-        {
-            g_sPlayer -> x -= 3;
-            g_sPlayer -> dir = 0;
-            g_sPlayer -> moving = 1;
-        } else if (key[KEY_RIGHT] || key[KEY_D]) // Go right
-        {
-            g_sPlayer -> x += 3;
-            g_sPlayer -> dir = 1;
-            g_sPlayer -> moving = 1;
-        } else {
-            g_sPlayer -> frame = 0; // Stop moving
-        }
+    if (g_pRecording != NULL)
+        replayRecord(g_pRecording, nInput, simChecksum());
 
-        // Wants to jump
-        if (key[KEY_UP] || key[KEY_W])
-            g_sPlayer -> jumpqueued = 1;
+    if (g_pPlayback != NULL) {
+        if (!replayCheck(g_pPlayback, g_nPlaybackTick, simChecksum()))
+            fprintf(stderr, "Replay differs at tick %ld\n", g_nPlaybackTick);
+        g_nPlaybackTick++;
     }
 
-    aiMovement();
+    // Act on what happened during the tick
+    if (g_nGemTicks > 0)
+        g_nGemTicks--;
+    drainEvents();
+}
 
-    moveActors();
+/**
+ * Copies an actor of the simulation into a frame
+ *
+ * Parameters:
+ * pActor		Receives the actor
+ * i			Slot of the actor
+ */
+void captureActor(RENDERACTOR * pActor, int i) {
+    pActor -> x = g_sActors.x[i];
+    pActor -> y = g_sActors.y[i];
+    pActor -> oldx = g_sActors.oldx[i];
+    pActor -> oldy = g_sActors.oldy[i];
+    pActor -> w = g_sActors.w[i];
+    pActor -> h = g_sActors.h[i];
+    pActor -> kind = g_sActors.kind[i];
+    pActor -> frame = g_sActors.frame[i];
+    pActor -> dir = g_sActors.dir[i];
+}
 
-    // Determine scrolling offsets for drawing
-    g_nMapX = g_sPlayer -> x + g_sPlayer -> w / 2 - SCREEN_W / 2;
-    g_nMapY = g_sPlayer -> y + g_sPlayer -> h / 2 - SCREEN_H / 2;
+/**
+ * Publishes everything the render thread needs to draw the game as it is
+ * now, without waiting for it
+ *
+ * Parameters:
+ * nAccum		Progress towards the next tick, 0 to TICK_UNIT
+ */
+void gameCapture(int nAccum) {
+    RENDERFRAME * pFrame = renderBack();
+    RENDERACTOR * pActor;
+    int i, n;
+    int nViewX, nViewY; // Camera of the player on this side
+
+    pFrame -> mode = g_nMode;
+    pFrame -> tick = g_nTick;
+    pFrame -> clock = paceNow();
+    pFrame -> accum = nAccum;
+
+    captureActor( & pFrame -> player, g_nLocal);
+    pFrame -> alive = g_sActors.alive[g_nLocal];
+    pFrame -> victory = g_bVictory;
+    pFrame -> score = localScore();
+    pFrame -> highscore = g_nHighScore;
+    pFrame -> timeleft = g_nTimeLeft;
+    pFrame -> gemvalue = g_nGemValue;
+    pFrame -> gemticks = g_nGemTicks;
+
+    // Other living actors in or near the view, the other player included
+    cameraFollow(g_sActors.x[g_nLocal], g_sActors.y[g_nLocal], g_sActors.w[g_nLocal], g_sActors.h[g_nLocal], & nViewX, & nViewY);
+    pFrame -> nactors = 0;
+    for (n = 0; n < g_nAwake; n++) {
+        i = g_pAwake[n];
+        if (!g_sActors.alive[i] || i == g_nLocal)
+            continue;
+
+        if (g_sActors.x[i] - nViewX <= -g_sActors.w[i] - RENDER_MARGIN ||
+            g_sActors.x[i] - nViewX >= VIEW_W + g_sActors.w[i] + RENDER_MARGIN ||
+            g_sActors.y[i] - nViewY <= -g_sActors.h[i] - RENDER_MARGIN ||
+            g_sActors.y[i] - nViewY >= VIEW_H + g_sActors.h[i] + RENDER_MARGIN)
+            continue;
+
+        pActor = renderAddActor(pFrame);
+        if (pActor == NULL)
+            break;
+        captureActor(pActor, i);
+    }
 
-    if (g_nMapX < 0)
-        g_nMapX = 0;
-    if (g_nMapX > MAP_WIDTH * 32 - SCREEN_W)
-        g_nMapX = MAP_WIDTH * 32 - SCREEN_W;
+    // Show taken gems
+    syncMap();
 
-    if (g_nMapY < 0)
-        g_nMapY = 0;
-    if (g_nMapY > MAP_HEIGHT * 32 - SCREEN_H)
-        g_nMapY = MAP_HEIGHT * 32 - SCREEN_H;
+    renderPublish();
+}
 
-    // Draw the map
-    MapDrawBG(g_bBuffer, g_nMapX, g_nMapY, 0, 0, SCREEN_W - 1, SCREEN_H - 1);
-    MapDrawFG(g_bBuffer, g_nMapX, g_nMapY, 0, 0, SCREEN_W - 1, SCREEN_H - 1, 0);
-    MapDrawFG(g_bBuffer, g_nMapX, g_nMapY, 0, 0, SCREEN_W - 1, SCREEN_H - 1, 1);
+/**
+ * Draws the game from a published frame, with actors placed between the
+ * last two ticks. Runs on the render thread.
+ *
+ * Parameters:
+ * pFrame		Frame to draw
+ * nAlpha		Progress towards the next tick, 0 to TICK_UNIT
+ */
+void gameDraw(const RENDERFRAME * pFrame, int nAlpha) {
+    const RENDERACTOR * pActor;
+    int n;
+    int bFlip;
+    int x, y; // Interpolated actor position
+    int nViewX, nViewY; // Interpolated camera position
+
+    // Follow the interpolated player
+    pActor = & pFrame -> player;
+    x = INTERPOLATE(pActor -> oldx, pActor -> x, nAlpha);
+    y = INTERPOLATE(pActor -> oldy, pActor -> y, nAlpha);
+    cameraFollow(x, y, pActor -> w, pActor -> h, & nViewX, & nViewY);
+
+    // Draw the map, only the tiles scrolled into view are drawn anew
+    mapCacheDraw(g_bBuffer, nViewX, nViewY);
 
     // Draw player, if alive
-    if (g_sPlayer -> alive) {
-        if (g_sPlayer -> dir) {
-            draw_sprite(g_bBuffer, g_sPlayer -> bitmaps[g_sPlayer -> frame], g_sPlayer -> x - g_nMapX, g_sPlayer -> y - g_nMapY);
+    if (pFrame -> alive) {
+        if (pActor -> dir) {
+            draw_sprite(g_bBuffer, g_bFrames[KIND_PLAYER][pActor -> frame], x - nViewX, y - nViewY);
         } else {
-            draw_sprite_h_flip(g_bBuffer, g_sPlayer -> bitmaps[g_sPlayer -> frame], g_sPlayer -> x - g_nMapX, g_sPlayer -> y - g_nMapY);
+            draw_sprite_h_flip(g_bBuffer, g_bFrames[KIND_PLAYER][pActor -> frame], x - nViewX, y - nViewY);
         }
     } else {
         // Game is over, check why
-        if (g_bVictory) {
+        if (pFrame -> victory) {
             textout_centre_ex(g_bBuffer, font, "VICTORY!",
                 SCREEN_W / 2, SCREEN_H / 2, makecol(0, 255, 0), -1);
         } else {
             textout_centre_ex(g_bBuffer, font, "You have died!",
                 SCREEN_W / 2, SCREEN_H / 2, makecol(255, 0, 0), -1);
         }
-
-        if (key[KEY_ENTER] || key[KEY_SPACE]) {
-            // Reload the map
-            MapFreeMem();
-            MapLoad("map.fmp");
-            // Reset the player
-            playerReset();
-        }
     }
 
-    // Draw other actors, if alive and in view
-    for (i = 1; i < g_nActors; i++) {
-        if (g_sActors[i] -> alive && actorVisible(i)) {
-            if (g_sActors[i] -> dir) {
-                draw_sprite_h_flip(g_bBuffer, g_sActors[i] -> bitmaps[g_sActors[i] -> frame], g_sActors[i] -> x - g_nMapX, g_sActors[i] -> y - g_nMapY);
-            } else {
-                draw_sprite(g_bBuffer, g_sActors[i] -> bitmaps[g_sActors[i] -> frame], g_sActors[i] -> x - g_nMapX, g_sActors[i] -> y - g_nMapY);
-            }
+    // Draw other actors, if in view
+    for (n = 0; n < pFrame -> nactors; n++) {
+        pActor = & pFrame -> actors[n];
+
+        x = INTERPOLATE(pActor -> oldx, pActor -> x, nAlpha) - nViewX;
+        y = INTERPOLATE(pActor -> oldy, pActor -> y, nAlpha) - nViewY;
+        if (x <= -pActor -> w || x >= SCREEN_W + pActor -> w ||
+            y <= -pActor -> h || y >= SCREEN_H + pActor -> h)
+            continue;
+
+        // Player frames face the other way from the rest
+        bFlip = pActor -> kind == KIND_PLAYER ? !pActor -> dir : pActor -> dir;
+        if (bFlip) {
+            draw_sprite_h_flip(g_bBuffer, g_bFrames[pActor -> kind][pActor -> frame], x, y);
+        } else {
+            draw_sprite(g_bBuffer, g_bFrames[pActor -> kind][pActor -> frame], x, y);
         }
     }
 
     // Display score	
-    textprintf_ex(g_bBuffer, font, 10, 10, makecol(255, 255, 255), -1, "Score: %i", g_nPlayerScore);
-    textprintf_ex(g_bBuffer, font, 10, 20, makecol(255, 255, 255), -1, "High Score: %i", g_nHighScore);
-    textprintf_ex(g_bBuffer, font, 10, 30, makecol(255, 255, 255), -1, "Time: %i", g_nTimeLeft);
+    textprintf_ex(g_bBuffer, font, 10, 10, makecol(255, 255, 255), -1, "Score: %i", pFrame -> score);
+    if (pFrame -> gemticks > 0)
+        textprintf_ex(g_bBuffer, font, 120, 10, makecol(255, 255, 0), -1, "+%i", pFrame -> gemvalue);
+    textprintf_ex(g_bBuffer, font, 10, 20, makecol(255, 255, 255), -1, "High Score: %i", pFrame -> highscore);
+    textprintf_ex(g_bBuffer, font, 10, 30, makecol(255, 255, 255), -1, "Time: %i", pFrame -> timeleft);
 }
 
 /**
- * Displays a step in the title screen loop
+ * Draws the title screen, runs on the render thread
  */
-int titleStep() {
-    static BITMAP * bLogo = NULL;
-
-    // Load logo when needed
-    if (bLogo == NULL)
-        bLogo = (BITMAP * ) g_dData[LOGO_BMP].dat;
+void titleDraw() {
+    BITMAP * bLogo = (BITMAP * ) g_dData[LOGO_BMP].dat;
 
     // Draw logo as a sprite
     draw_sprite(g_bBuffer, bLogo, SCREEN_W / 2 - bLogo -> w / 2, SCREEN_H / 3);
@@ -450,22 +434,24 @@ int titleStep() {
 
     // Display copyright
     textout_centre_ex(g_bBuffer, font, "Copyright (C) 2019 Lionel Pinkhard. All Rights Reserved.", SCREEN_W / 2, SCREEN_H * 3 / 4, makecol(255, 255, 255), -1);
+}
 
+/**
+ * Takes a step in the title screen loop
+ */
+int titleStep() {
     // Continue to gameplay
-    if (key[KEY_SPACE] || key[KEY_ENTER]) {
-        // Clean up first
-        bLogo = NULL;
+    if (key[KEY_SPACE] || key[KEY_ENTER])
         return MODE_GAMEPLAY;
-    }
 
     // Stay in intro
     return MODE_INTRO;
 }
 
 /**
- * Displays the help screen
+ * Draws the help screen, runs on the render thread
  */
-int helpStep() {
+void helpDraw() {
     int nTitleColor = makecol(0xf9, 0xef, 0x06); // Color of the title text
     int nTextColor = makecol(0xf9, 0xef, 0xf6); // Color of the other text
 
@@ -480,6 +466,7 @@ int helpStep() {
     textout_ex(g_bBuffer, font, "Left arrow / A    Move to the left", SCREEN_W / 3 - 20, SCREEN_H * 0.3, nTextColor, -1);
     textout_ex(g_bBuffer, font, "Right arrow / D   Move to the left", SCREEN_W / 3 - 20, SCREEN_H * 0.35, nTextColor, -1);
     textout_ex(g_bBuffer, font, "Up arrow / W      Jump", SCREEN_W / 3 - 20, SCREEN_H * 0.4, nTextColor, -1);
+    textout_ex(g_bBuffer, font, "Backspace         Rewind", SCREEN_W / 3 - 20, SCREEN_H * 0.45, nTextColor, -1);
     textout_ex(g_bBuffer, font, "Ctrl-H            Display help", SCREEN_W / 3 - 20, SCREEN_H * 0.5, nTextColor, -1);
     textout_ex(g_bBuffer, font, "Ctrl-M            Toggle music", SCREEN_W / 3 - 20, SCREEN_H * 0.55, nTextColor, -1);
 
@@ -488,7 +475,12 @@ int helpStep() {
     textout_centre_ex(g_bBuffer, font, "Avoid touching the deadly plants", SCREEN_W / 2, SCREEN_H * 0.75, nTextColor, -1);
 
     textout_centre_ex(g_bBuffer, font, "Press SPACE or ENTER to continue playing...", SCREEN_W / 2, SCREEN_H * 0.85, nTextColor, -1);
+}
 
+/**
+ * Takes a step in the help screen loop
+ */
+int helpStep() {
     // Check for key press
     if (key[KEY_ENTER] || key[KEY_SPACE]) {
         return MODE_GAMEPLAY;
@@ -498,109 +490,226 @@ int helpStep() {
 }
 
 /**
- * Handles times
+ * Returns nonzero if vsync() really waits for the retrace. Windowed modes
+ * often return at once, which would leave drawing to spin.
+ */
+int vsyncWaits() {
+    double dStart;
+    int i;
+
+    vsync();
+    dStart = paceNow();
+    for (i = 0; i < VSYNC_PROBES; i++)
+        vsync();
+
+    return (paceNow() - dStart) / VSYNC_PROBES >= VSYNC_MIN_US;
+}
+
+/**
+ * Draws whatever the simulation published last, once per refresh, until
+ * told to stop. Paced by the retrace where vsync() waits for it, by the
+ * clock otherwise, and sleeps through frames where nothing changed.
  */
-void * timeThread(void * data) {
-    int my_thread_id = * ((int * ) data);
+void * drawThread(void * pData) {
+    const RENDERFRAME * pFrame;
+    int bNew;
+    int bVsync = vsyncWaits();
+    int nAlpha;
+    int nShown = -1; // Alpha last drawn, -1 to draw the next frame
     int i;
 
-    while (!g_bExiting) {
-        if (g_nMode == MODE_GAMEPLAY) {
-            // Lock mutex and process time
-            pthread_mutex_lock( & threadsafe);
-
-            // Kill player if time runs out		
-            if (g_nTimeLeft > 0) {
-                g_nTimeLeft--;
-
-                if (g_nTimeLeft <= 0) {
-                    if (g_sPlayer -> alive) {
-                        g_sPlayer -> alive = 0;
-                        play_sample(g_sDie, 250, 128, 1000, 0);
-                    }
-                }
+    (void) pData;
+
+    paceStart( & g_sDrawPacer, "draw", 1e6 / (get_refresh_rate() > 0 ? get_refresh_rate() : DEFAULT_REFRESH));
+
+    while (!g_bDrawStop) {
+        pFrame = renderTake( & bNew);
+
+        // Nothing new to show, wait for the next refresh
+        if (pFrame == NULL || (!bNew && (pFrame -> mode != MODE_GAMEPLAY || nShown == TICK_UNIT))) {
+            paceWait( & g_sDrawPacer);
+            continue;
+        }
+
+        // Show taken gems, Mappy belongs to this thread
+        if (bNew) {
+            for (i = 0; i < pFrame -> ncells; i++) {
+                MapSetBlock(pFrame -> cells[i].cell % mapwidth, pFrame -> cells[i].cell / mapwidth, pFrame -> cells[i].block);
+                mapCacheCell(pFrame -> cells[i].cell % mapwidth, pFrame -> cells[i].cell / mapwidth);
             }
+        }
 
-            pthread_mutex_unlock( & threadsafe);
+        switch (pFrame -> mode) {
+        case MODE_INTRO:
+            titleDraw();
+            nShown = TICK_UNIT;
+            break;
+        case MODE_GAMEPLAY:
+            // Carry on between ticks from where the simulation left off
+            nAlpha = pFrame -> accum + (int)((paceNow() - pFrame -> clock) * TICK_RATE / 1000);
+            nShown = nAlpha < TICK_UNIT ? nAlpha : TICK_UNIT;
+            gameDraw(pFrame, nShown);
+            break;
+        case MODE_HELP:
+            helpDraw();
+            nShown = TICK_UNIT;
+            break;
+        }
 
-            // Wait for next second
-            rest(1000);
+        // Draw buffer to screen on the next refresh
+        if (bVsync) {
+            vsync();
+            paceMark( & g_sDrawPacer);
+        } else {
+            paceWait( & g_sDrawPacer);
         }
+        acquire_screen();
+        blit(g_bBuffer, screen, 0, 0, 0, 0, SCREEN_W - 1, SCREEN_H - 1);
+        release_screen();
     }
 
-    pthread_exit(NULL);
     return NULL;
 }
 
 /**
- * Handles the main loop for the game, regardless of current state
+ * Takes the buttons for a tick from the input queue, acting on Ctrl-H and
+ * Ctrl-M as they are pressed. Returns the buttons.
+ *
+ * Parameters:
+ * dBefore		When the tick ended, on the pace.c clock
+ * dNow			When the tick runs, 0 if it is not a game tick
  */
-void gameLoop() {
+int takeInput(double dBefore, double dNow) {
     static int bMusic = 1;
-
-    // Main game loop
-    while (!key[KEY_ESC]) {
-        // Check for help key or music key
-        if (key_shifts & KB_CTRL_FLAG) {
-            if (key[KEY_H]) {
-                // Switch to help mode
-                g_nMode = MODE_HELP;
-
-                // Slight wait
-                rest(10);
-            } else if (key[KEY_M]) {
-                if (bMusic) {
-                    // Pause music
-                    midi_pause();
-                    bMusic = 0;
-                } else {
-                    // Resumse music
-                    midi_resume();
-                    bMusic = 1;
-                }
-                // Slight wait
-                rest(10);
+    int nButtons = inputTake( & g_sInput, & g_sInputQueue, dBefore, dNow);
+
+    // Check for help key or music key
+    if (nButtons & BUTTON_CTRL) {
+        if (g_sInput.pressed & BUTTON_HELP) {
+            // Switch to help mode
+            g_nMode = MODE_HELP;
+        } else if (g_sInput.pressed & BUTTON_MUSIC) {
+            if (bMusic) {
+                // Pause music
+                midi_pause();
+                bMusic = 0;
+            } else {
+                // Resume music
+                midi_resume();
+                bMusic = 1;
             }
         }
+    }
+
+    return nButtons;
+}
+
+/**
+ * Handles the main loop for the game, regardless of current state. Only
+ * simulates, the render thread draws what it publishes.
+ */
+void gameLoop() {
+    double dLast = paceNow(); // Time banked up to, in microseconds
+    double dNow;
+    int nAccum = 0; // Simulation time owed, TICK_UNIT per tick
+    int nBanked; // Units banked this frame
+    int nTicks; // Ticks run this frame
+    int nShown = -1; // Mode last published
 
-        // Draw the right contents
+    paceStart( & g_sTickPacer, "ticks", 1e6 / TICK_RATE);
+
+    // Main game loop
+    while (!key[KEY_ESC]) {
+        // Bank the time since the last frame, keeping the part too small
+        // for a whole unit for the next one
+        dNow = paceNow();
+        nBanked = (int)((dNow - dLast) * TICK_RATE / 1000);
+        nAccum += nBanked;
+        dLast += nBanked * 1000.0 / TICK_RATE;
+
+        // Step the right contents
+        nTicks = 0;
         switch (g_nMode) {
         case MODE_INTRO:
+            takeInput(dNow, 0);
             g_nMode = titleStep();
+            nAccum = 0;
             break;
         case MODE_GAMEPLAY:
-            // Perform a step in the game
-            /*if (pthread_mutex_lock(&threadsafe))
-            { */
-            gameStep();
-            //pthread_mutex_unlock(&threadsafe);
-            //}
+            // Run the simulation at a fixed rate, whatever the frame rate.
+            // Each tick takes the keys changed before it ended, which was
+            // as long ago as the time still owed after it.
+            for (nTicks = 0; nAccum >= TICK_UNIT && nTicks < MAX_TICKS_PER_FRAME && g_nMode == MODE_GAMEPLAY; nTicks++) {
+                nAccum -= TICK_UNIT;
+                gameTick(takeInput(dLast - nAccum * 1000.0 / TICK_RATE, paceNow()));
+            }
+
+            // Too far behind, drop the backlog rather than spiral
+            if (nAccum >= TICK_UNIT)
+                nAccum %= TICK_UNIT;
             break;
         case MODE_HELP:
+            takeInput(dNow, 0);
             g_nMode = helpStep();
+            nAccum = 0;
             break;
         }
 
-        // Draw buffer to screen
-        vsync();
-        acquire_screen();
-        blit(g_bBuffer, screen, 0, 0, 0, 0, SCREEN_W - 1, SCREEN_H - 1);
-        release_screen();
+        // Hand over anything new, then sleep until the next tick is due
+        if (nTicks > 0 || g_nMode != nShown) {
+            gameCapture(nAccum);
+            nShown = g_nMode;
+        }
+        paceWait( & g_sTickPacer);
+    }
+}
+
+/**
+ * Plays back a replay as fast as the simulation goes, publishing every
+ * tick for the render thread to draw what it can
+ */
+void replayLoop() {
+    double dStart = paceNow(); // Clock when playback started
+
+    while (!key[KEY_ESC] && g_nPlaybackTick < g_pPlayback -> nticks) {
+        gameTick(0);
+        gameCapture(TICK_UNIT);
     }
+
+    fprintf(stderr, "Replayed %ld ticks in %.0f ms\n", g_nPlaybackTick, (paceNow() - dStart) / 1000);
 }
 
 /**
  * Main entry point for the game
+ *
+ * Usage: game [-record file | -replay file | -netplay player [-peer address]]
  */
-int main(void) {
+int main(int argc, char * argv[]) {
     BITMAP * tmp; // Temporary bitmap
     MIDI * mMusic; // Background music
     FILE * fp; // File pointer for scores
     int i, j; // Index counters
-
-    // Threading for timer
-    pthread_t pthread0;
-    int threadid0 = 0;
+    pthread_t pDraw; // Render thread
+
+    // Replay options
+    const char * szRecord = NULL;
+    const char * szReplay = NULL;
+
+    // Netplay options, player 0 listens on NETPLAY_PORT and player 1 on
+    // the port after
+    int nNetplay = -1;
+    const char * szPeer = "127.0.0.1";
+
+    for (i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-record"))
+            szRecord = argv[i + 1];
+        else if (!strcmp(argv[i], "-replay"))
+            szReplay = argv[i + 1];
+        else if (!strcmp(argv[i], "-netplay"))
+            nNetplay = atoi(argv[i + 1]) == RIVAL ? RIVAL : PLAYER;
+        else if (!strcmp(argv[i], "-peer"))
+            szPeer = argv[i + 1];
+    }
 
     // Initialize Allegro
     allegro_init();
@@ -613,6 +722,11 @@ int main(void) {
     install_keyboard();
     install_timer();
 
+    // Have key changes queued as they happen
+    LOCK_VARIABLE(g_sInputQueue);
+    LOCK_FUNCTION(keyHandler);
+    keyboard_lowlevel_callback = keyHandler;
+
     // Set up sound
     if (install_sound(DIGI_AUTODETECT, MIDI_AUTODETECT, "") != 0) {
         allegro_message("Error initializing the sound system: %s", allegro_error);
@@ -622,31 +736,27 @@ int main(void) {
     // Load the data file
     g_dData = load_datafile("game.dat");
 
-    // Load the map
+    // Load the map for drawing, and again for the simulation
     MapLoad("map.fmp");
+    if (simInit("map.fmp") != 0) {
+        allegro_message("Error loading the map");
+        return 1;
+    }
 
-    // Set up sprites
-    for (i = 0; i < g_nActors; i++)
-        g_sActors[i] = malloc(sizeof(SPRITE));
-
-    // Player is also an actor
-    g_sPlayer = g_sActors[0];
+    // Keep the layer as loaded
+    g_pMapCells = malloc(g_pLevel -> width * g_pLevel -> height * sizeof(short));
+    memcpy(g_pMapCells, mappt, g_pLevel -> width * g_pLevel -> height * sizeof(short));
 
     // Load player sprite frames
     tmp = (BITMAP * ) g_dData[PLAYER_BMP].dat;
     for (i = 0; i < 8; i++) {
-        g_sPlayer -> bitmaps[i] = grabFrame(tmp, 34, 42, 0, 0, 8, i);
+        g_bFrames[KIND_PLAYER][i] = grabFrame(tmp, PLAYER_W, PLAYER_H, 0, 0, 8, i);
     }
 
     // Load plant sprite frames
     tmp = (BITMAP * ) g_dData[PLANT_BMP].dat;
     for (i = 0; i < 3; i++) {
-        g_sActors[1] -> bitmaps[i] = grabFrame(tmp, 50, 42, 0, 0, 3, i);
-
-        // Copy frames
-        g_sActors[2] -> bitmaps[i] = g_sActors[1] -> bitmaps[i];
-        g_sActors[3] -> bitmaps[i] = g_sActors[1] -> bitmaps[i];
-        g_sActors[4] -> bitmaps[i] = g_sActors[1] -> bitmaps[i];
+        g_bFrames[KIND_PLANT][i] = grabFrame(tmp, PLANT_W, PLANT_H, 0, 0, 3, i);
     }
 
     // Load high score from file
@@ -656,11 +766,13 @@ int main(void) {
         fclose(fp);
     }
 
-    playerReset();
-
-    // Create the memory buffer
+    // Create the memory buffer, and the map tiles kept around the view
     g_bBuffer = create_bitmap(SCREEN_W, SCREEN_H);
     clear(g_bBuffer);
+    if (mapCacheCreate(SCREEN_W, SCREEN_H) != 0) {
+        allegro_message("Error creating the map cache");
+        return 1;
+    }
 
     // Load and play music
     mMusic = (MIDI * ) g_dData[MUSIC_MID].dat;
@@ -671,28 +783,87 @@ int main(void) {
     g_sDie = (SAMPLE * ) g_dData[DIE_WAV].dat;
     g_sWin = (SAMPLE * ) g_dData[WIN_WAV].dat;
 
-    // Start time thread
-    pthread_create( & pthread0, NULL, timeThread, (void * ) & threadid0);
+    if (nNetplay >= 0) {
+        g_pLink = netOpen(NETPLAY_PORT + nNetplay, szPeer, NETPLAY_PORT + 1 - nNetplay);
+        g_pRollback = rollbackCreate(nNetplay, NETPLAY_DELAY);
+        if (g_pLink == NULL || g_pRollback == NULL) {
+            allegro_message("Error opening port %d for netplay", NETPLAY_PORT + nNetplay);
+            netClose(g_pLink);
+            rollbackFree(g_pRollback);
+            g_pLink = NULL;
+            g_pRollback = NULL;
+        } else {
+            g_nLocal = nNetplay;
+            simPlayers(2);
+        }
+    } else if (szReplay != NULL) {
+        g_pPlayback = replayLoad(szReplay);
+        if (g_pPlayback == NULL)
+            allegro_message("Error loading replay %s", szReplay);
+    } else if (szRecord != NULL) {
+        g_pRecording = replayCreate();
+    }
 
-    // Enter the game loop
-    gameLoop();
+    // Replays play as recorded and netplay goes back on its own, anything
+    // else can be rewound
+    if (g_pPlayback == NULL && g_pRollback == NULL) {
+        g_pRewind = rewindCreate(REWIND_BUDGET, REWIND_KEY_EVERY);
+        if (g_pRewind != NULL)
+            rewindPush(g_pRewind, g_nTick);
+    }
 
-    // Busy exiting, thread cleanup
-    g_bExiting = 1;
-    rest(200);
-    pthread_mutex_destroy( & threadsafe);
+    // Drawing happens on a thread of its own from here on
+    pthread_create( & pDraw, NULL, drawThread, NULL);
 
-    // Free the memory buffer
+    // Enter the game loop
+    if (g_pPlayback != NULL) {
+        g_nMode = MODE_GAMEPLAY;
+        replayLoop();
+    } else {
+        gameLoop();
+    }
+
+    g_bDrawStop = 1;
+    pthread_join(pDraw, NULL);
+    renderFree();
+
+    // Keys are no longer wanted
+    keyboard_lowlevel_callback = NULL;
+
+    // How steady the frames were, and how soon keys were acted on
+    if (g_pPlayback == NULL)
+        paceReport( & g_sTickPacer, stderr);
+    paceReport( & g_sDrawPacer, stderr);
+    mapCacheReport(stderr);
+    if (g_sInput.presses > 0)
+        fprintf(stderr, "input: %ld presses, %.3f ms to their tick on average, %.3f ms at most, %ld dropped\n",
+            g_sInput.presses, g_sInput.latency / g_sInput.presses / 1e3, g_sInput.worst / 1e3, g_sInputQueue.dropped);
+
+    // Keep what was recorded
+    if (g_pRecording != NULL && replaySave(g_pRecording, szRecord) != 0)
+        allegro_message("Error saving replay %s", szRecord);
+
+    // How often netplay had to go back
+    if (g_pRollback != NULL)
+        fprintf(stderr, "netplay: %ld rollbacks, %ld ticks played again, deepest %ld, %ld stalls, %ld desyncs\n",
+            g_pRollback -> rollbacks, g_pRollback -> resimulated, g_pRollback -> deepest,
+            g_pRollback -> stalls, g_pRollback -> desyncs);
+
+    replayFree(g_pRecording);
+    replayFree(g_pPlayback);
+    rewindFree(g_pRewind);
+    rollbackFree(g_pRollback);
+    netClose(g_pLink);
+
+    // Free the memory buffer and the map tiles
     destroy_bitmap(g_bBuffer);
+    mapCacheFree();
 
-    // Free the map
+    // Free the map and the simulation
+    simShutdown();
+    free(g_pMapCells);
     MapFreeMem();
 
-    // Free sprites
-    for (i = 0; i < g_nActors; i++) {
-        free(g_sActors[i]);
-    }
-
     unload_datafile(g_dData);
 
     // Sound cleanup
@@ -16,6 +16,7 @@
 #include <allegro.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Include pthread
 #include "pthread.h"
@@ -24,38 +25,57 @@
 #include "defines.h"
 #include "mappyal.h"
 #include "util.h"
+#include "sim.h"
+#include "replay.h"
+#include "rewind.h"
+#include "render.h"
+#include "mapcache.h"
+#include "pace.h"
+#include "input.h"
+#include "net.h"
+#include "rollback.h"
 
 // Defines for the game
-#define JUMPIT	1600
-
-#define MAP_WIDTH 1500
-#define MAP_HEIGHT 25
-
 #define MODE_INTRO 0
 #define MODE_GAMEPLAY 1
 #define MODE_HELP 2
 
-#define NUM_ACTORS 5
-
-// Sprite structure
-typedef struct SPRITE
-{
-	int active;
-	int alive;
-	int player;
-	int x, y;
-	int oldx, oldy;
-	int moving;
-	int dir;
-	int jump;
-	int jumpqueued;
-	BITMAP *bitmaps[8];
-	int w, h;
-	int xspd, yspd;
-	int xdelay, ydelay;
-	int xcount, ycount;
-	int frame, maxframe, animdir;
-	int framecount, framedelay;
-} SPRITE;
+// Buttons the game loop takes besides the INPUT_* ones of the simulation
+#define BUTTON_REWIND 0x100
+#define BUTTON_CTRL 0x200
+#define BUTTON_HELP 0x400
+#define BUTTON_MUSIC 0x800
+
+// One tick of banked time, in milliseconds times TICK_RATE
+#define TICK_UNIT 1000
+
+// Most ticks to catch up on in a single frame
+#define MAX_TICKS_PER_FRAME 5
+
+// Position between two ticks, alpha from 0 to TICK_UNIT
+#define INTERPOLATE(old, cur, alpha) ((old) + ((cur) - (old)) * (alpha) / TICK_UNIT)
+
+// Bytes kept to rewind through, half an hour of play on the stock map
+#define REWIND_BUDGET (4 << 20)
+
+// Netplay: UDP port of player 0, player 1 uses the next, and ticks of
+// input delay
+#define NETPLAY_PORT 7000
+#define NETPLAY_DELAY 2
+
+// Actors this far outside the view are still handed to the renderer, which
+// draws them between ticks with a moving camera, in pixels
+#define RENDER_MARGIN 64
+
+// Refresh rate to pace drawing to when the driver doesn't say
+#define DEFAULT_REFRESH 60
+
+// Retraces timed to tell whether vsync() waits, and the shortest wait
+// between them that counts as waiting, in microseconds
+#define VSYNC_PROBES 4
+#define VSYNC_MIN_US 2000
+
+// Most animation frames of an actor
+#define MAX_FRAMES 8
 
 #endif
@@ -0,0 +1,163 @@
+/**
+ * File:        mapcache.c
+ * Purpose:     Keeps the map layers around the view drawn in a bitmap, so a
+ *              frame only draws the tiles scrolled into view and the cells
+ *              that changed. Used by the render thread only.
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include "mapcache.h"
+#include "mappyal.h"
+
+// Tiles around the view, composed of the background and both foreground
+// layers. Tile (tx, ty) always sits at (tx % cols, ty % rows), so the view
+// can move without anything held being moved.
+static BITMAP * s_bCache = NULL;
+static int s_nCols = 0;
+static int s_nRows = 0;
+
+// Top left tile held, and whether anything is held yet
+static int s_nTileX = 0;
+static int s_nTileY = 0;
+static int s_bValid = 0;
+
+// Totals, for measuring
+static long s_nFrames = 0;
+static long s_nTiles = 0;
+
+/**
+ * Creates the cache for a view of a given size, once the map is loaded.
+ * Returns -1 when out of memory.
+ *
+ * Parameters:
+ * w			Width of the view, in pixels
+ * h			Height of the view, in pixels
+ */
+int mapCacheCreate(int w, int h) {
+    mapCacheFree();
+
+    // A view that does not start on a tile edge spans one tile more
+    s_nCols = (w + mapblockwidth - 1) / mapblockwidth + 1;
+    s_nRows = (h + mapblockheight - 1) / mapblockheight + 1;
+
+    s_bCache = create_bitmap(s_nCols * mapblockwidth, s_nRows * mapblockheight);
+    if (s_bCache == NULL)
+        return -1;
+
+    s_bValid = 0;
+
+    return 0;
+}
+
+/**
+ * Frees the cache
+ */
+void mapCacheFree(void) {
+    if (s_bCache != NULL)
+        destroy_bitmap(s_bCache);
+
+    s_bCache = NULL;
+    s_bValid = 0;
+}
+
+/**
+ * Draws a tile of the map into its place in the cache
+ *
+ * Parameters:
+ * tx			Column of the tile
+ * ty			Row of the tile
+ */
+static void mapCacheTile(int tx, int ty) {
+    int x = (tx % s_nCols) * mapblockwidth;
+    int y = (ty % s_nRows) * mapblockheight;
+
+    s_nTiles++;
+
+    // The view can end on the edge of the map
+    if (tx >= mapwidth || ty >= mapheight) {
+        rectfill(s_bCache, x, y, x + mapblockwidth - 1, y + mapblockheight - 1, 0);
+        return;
+    }
+
+    MapDrawBG(s_bCache, tx * mapblockwidth, ty * mapblockheight, x, y, mapblockwidth, mapblockheight);
+    MapDrawFG(s_bCache, tx * mapblockwidth, ty * mapblockheight, x, y, mapblockwidth, mapblockheight, 0);
+    MapDrawFG(s_bCache, tx * mapblockwidth, ty * mapblockheight, x, y, mapblockwidth, mapblockheight, 1);
+}
+
+/**
+ * Draws the map as seen from a camera position: brings in the tiles that
+ * scrolled into view, then copies the view out of the cache in up to four
+ * pieces where it wraps around
+ *
+ * Parameters:
+ * pDest		Bitmap to draw to, the size of the view
+ * nViewX		Camera X coordinate, at least 0
+ * nViewY		Camera Y coordinate, at least 0
+ */
+void mapCacheDraw(BITMAP * pDest, int nViewX, int nViewY) {
+    int nTileX = nViewX / mapblockwidth;
+    int nTileY = nViewY / mapblockheight;
+    int nCacheW = s_nCols * mapblockwidth;
+    int nCacheH = s_nRows * mapblockheight;
+    int x, y, w, h;
+    int tx, ty;
+
+    // Only the tiles that were not held before
+    for (ty = nTileY; ty < nTileY + s_nRows; ty++) {
+        for (tx = nTileX; tx < nTileX + s_nCols; tx++) {
+            if (s_bValid && tx >= s_nTileX && tx < s_nTileX + s_nCols && ty >= s_nTileY && ty < s_nTileY + s_nRows)
+                continue;
+            mapCacheTile(tx, ty);
+        }
+    }
+
+    s_nTileX = nTileX;
+    s_nTileY = nTileY;
+    s_bValid = 1;
+    s_nFrames++;
+
+    // Where the view starts in the cache, and the part before it wraps
+    x = nViewX % nCacheW;
+    y = nViewY % nCacheH;
+    w = nCacheW - x < pDest -> w ? nCacheW - x : pDest -> w;
+    h = nCacheH - y < pDest -> h ? nCacheH - y : pDest -> h;
+
+    blit(s_bCache, pDest, x, y, 0, 0, w, h);
+    if (w < pDest -> w)
+        blit(s_bCache, pDest, 0, y, w, 0, pDest -> w - w, h);
+    if (h < pDest -> h)
+        blit(s_bCache, pDest, x, 0, 0, h, w, pDest -> h - h);
+    if (w < pDest -> w && h < pDest -> h)
+        blit(s_bCache, pDest, 0, 0, w, h, pDest -> w - w, pDest -> h - h);
+}
+
+/**
+ * Draws a cell again after it was changed with MapSetBlock, if it is held
+ *
+ * Parameters:
+ * tx			Column of the cell
+ * ty			Row of the cell
+ */
+void mapCacheCell(int tx, int ty) {
+    if (s_bValid && tx >= s_nTileX && tx < s_nTileX + s_nCols && ty >= s_nTileY && ty < s_nTileY + s_nRows)
+        mapCacheTile(tx, ty);
+}
+
+/**
+ * Writes how many tiles frames have drawn on average, against drawing the
+ * whole view every frame
+ *
+ * Parameters:
+ * fp			Where to write
+ */
+void mapCacheReport(FILE * fp) {
+    if (s_nFrames == 0)
+        return;
+
+    fprintf(fp, "map: %ld frames, %.1f tiles drawn per frame, %d for the whole view\n",
+        s_nFrames, (double) s_nTiles / s_nFrames, s_nCols * s_nRows);
+}
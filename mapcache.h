@@ -0,0 +1,27 @@
+/**
+ * File:        mapcache.h
+ * Purpose:     Header file for mapcache.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _MAPCACHE_H_
+#define _MAPCACHE_H_
+
+// Include Allegro library and C stdlib
+#include <allegro.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Function declarations
+int mapCacheCreate(int w, int h);
+void mapCacheFree(void);
+void mapCacheDraw(BITMAP * pDest, int nViewX, int nViewY);
+void mapCacheCell(int tx, int ty);
+void mapCacheReport(FILE * fp);
+
+#endif
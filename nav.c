@@ -0,0 +1,527 @@
+/**
+ * File:        nav.c
+ * Purpose:     Platform navigation graph extracted from the collision plane
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "nav.h"
+#include "collide.h"
+#include "level.h"
+
+// Initial jump counter, as set by moveActors when the player jumps
+#define NAV_JUMP_START 32
+
+// Platform graph
+NAVSEG * g_pNavSegs = NULL;
+int g_nNavSegs = 0;
+static int s_nSegCap = 0;
+
+// Bumped on every rebuild or patch, so routes through old segments expire
+int g_nNavVersion = 0;
+
+// Segment standing on each surface sub-tile, or -1
+static short * s_pSegAt = NULL;
+
+// Recycled segment slots
+static short * s_pFree = NULL;
+static int s_nFree = 0;
+
+// Jump arc, height above the takeoff point after each tick
+static int * s_pArc = NULL;
+static int s_nArc = 0;
+static int s_nApex = 0;
+
+// Furthest horizontal distance any link can cover, in sub-tiles
+static int s_nReach = 0;
+
+/**
+ * Simulates a jump with the same rules as moveActors and records the arc
+ */
+static int buildArc(void) {
+    int nJump = NAV_JUMP_START;
+    int nHeight = 0;
+    int nFloor = -(g_nCollisionH << SUBTILE_SHIFT);
+    int t;
+
+    // Count the ticks first, until the arc leaves the bottom of the map
+    for (s_nArc = 1; nHeight > nFloor; s_nArc++) {
+        nHeight += nJump / 3;
+        nJump--;
+    }
+
+    s_pArc = malloc(s_nArc * sizeof(int));
+    if (s_pArc == NULL)
+        return -1;
+
+    nJump = NAV_JUMP_START;
+    nHeight = 0;
+    s_nApex = 0;
+    s_pArc[0] = 0;
+    for (t = 1; t < s_nArc; t++) {
+        nHeight += nJump / 3;
+        nJump--;
+        s_pArc[t] = nHeight;
+        if (nHeight > s_pArc[s_nApex])
+            s_nApex = t;
+    }
+
+    s_nReach = (s_nArc * NAV_WALK_SPEED >> SUBTILE_SHIFT) + 2;
+    return 0;
+}
+
+/**
+ * Returns the ticks a jump takes to come down onto a surface the given
+ * number of pixels above the takeoff point, or -1 if it is out of reach
+ *
+ * Parameters:
+ * rise			Height of the landing surface, negative if lower
+ */
+int navJumpTicks(int rise) {
+    int t;
+
+    if (s_pArc == NULL || rise > s_pArc[s_nApex])
+        return -1;
+
+    for (t = s_nApex + 1; t < s_nArc; t++)
+        if (s_pArc[t] <= rise)
+            return t;
+
+    return -1;
+}
+
+/**
+ * Returns the ticks needed to fall the given number of pixels after
+ * walking off an edge
+ *
+ * Parameters:
+ * drop			Distance to fall
+ */
+int navFallTicks(int drop) {
+    int t;
+
+    if (s_pArc == NULL)
+        return -1;
+
+    for (t = s_nApex + 1; t < s_nArc; t++)
+        if (s_pArc[s_nApex] - s_pArc[t] >= drop)
+            return t - s_nApex;
+
+    return -1;
+}
+
+/**
+ * Checks whether an actor can stand on the given surface sub-tile
+ *
+ * Parameters:
+ * cx			Sub-tile column
+ * row			Sub-tile row of the surface
+ */
+static int standable(int cx, int row) {
+    int i;
+
+    if (!collisionSubTile(cx, row))
+        return 0;
+
+    for (i = 1; i <= NAV_CLEARANCE; i++)
+        if (collisionSubTile(cx, row - i))
+            return 0;
+
+    return 1;
+}
+
+/**
+ * Checks whether an actor's feet may pass through the given sub-tile
+ *
+ * Parameters:
+ * cx			Sub-tile column
+ * row			Sub-tile row
+ */
+static int spikeSubTile(int cx, int row) {
+    return spikeCheck((cx << SUBTILE_SHIFT) + SUBTILE_SIZE / 2, (row << SUBTILE_SHIFT) + SUBTILE_SIZE / 2);
+}
+
+/**
+ * Returns the segment standing on the given surface sub-tile, or -1
+ *
+ * Parameters:
+ * cx			Sub-tile column
+ * row			Sub-tile row of the surface
+ */
+int navSegmentAt(int cx, int row) {
+    if (s_pSegAt == NULL || cx < 0 || row < 0 || cx >= g_nCollisionW || row >= g_nCollisionH)
+        return -1;
+
+    return s_pSegAt[row * g_nCollisionW + cx];
+}
+
+/**
+ * Returns the segment an actor with its feet at the given pixel would
+ * stand on or land on first, or -1 if there is none
+ *
+ * Parameters:
+ * x			X coordinate of the feet
+ * y			Y coordinate of the feet
+ */
+int navSegmentBelow(int x, int y) {
+    int cx = x >> SUBTILE_SHIFT;
+    int row;
+    int nSeg;
+
+    for (row = y >> SUBTILE_SHIFT; row < g_nCollisionH; row++) {
+        if (row < 0)
+            continue;
+
+        nSeg = navSegmentAt(cx, row);
+        if (nSeg >= 0)
+            return nSeg;
+        if (collisionSubTile(cx, row))
+            return -1;
+    }
+
+    return -1;
+}
+
+/**
+ * Allocates a segment slot, reusing a dead one when possible
+ */
+static int newSegment(void) {
+    NAVSEG * pNew;
+    short * pNewFree;
+    int nCap;
+
+    if (s_nFree > 0)
+        return s_pFree[--s_nFree];
+
+    // Both buffers keep their contents if either fails, and the capacity
+    // only grows once both have
+    if (g_nNavSegs == s_nSegCap) {
+        nCap = s_nSegCap ? s_nSegCap * 2 : 256;
+
+        pNewFree = realloc(s_pFree, nCap * sizeof(short));
+        if (pNewFree == NULL)
+            return -1;
+        s_pFree = pNewFree;
+
+        pNew = realloc(g_pNavSegs, nCap * sizeof(NAVSEG));
+        if (pNew == NULL)
+            return -1;
+        g_pNavSegs = pNew;
+
+        s_nSegCap = nCap;
+    }
+
+    return g_nNavSegs++;
+}
+
+/**
+ * Extracts the segments of one surface row within a column range
+ *
+ * Parameters:
+ * row			Sub-tile row of the surface
+ * lo			First sub-tile column to scan
+ * hi			Last sub-tile column to scan
+ */
+static int extractRow(int row, int lo, int hi) {
+    NAVSEG * pSeg;
+    int cx, x0, i;
+    int nSeg;
+
+    for (cx = lo; cx <= hi; cx++) {
+        if (!standable(cx, row))
+            continue;
+
+        // Find the end of the run
+        x0 = cx;
+        while (cx + 1 <= hi && standable(cx + 1, row))
+            cx++;
+
+        nSeg = newSegment();
+        if (nSeg < 0)
+            return -1;
+
+        pSeg = & g_pNavSegs[nSeg];
+        pSeg -> row = row;
+        pSeg -> x0 = x0;
+        pSeg -> x1 = cx;
+        pSeg -> alive = 1;
+        pSeg -> hazard = 0;
+        pSeg -> nlinks = 0;
+
+        for (i = x0; i <= cx; i++) {
+            s_pSegAt[row * g_nCollisionW + i] = nSeg;
+            if (spikeSubTile(i, row - 1))
+                pSeg -> hazard = 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Adds a link to a candidate list, keeping only the cheapest ones
+ *
+ * Parameters:
+ * pSeg			Segment to add the link to
+ * pLink		Link to add
+ */
+static void addLink(NAVSEG * pSeg, const NAVLINK * pLink) {
+    int i;
+
+    if (pSeg -> nlinks < NAV_MAX_LINKS) {
+        i = pSeg -> nlinks++;
+    } else {
+        if (pLink -> cost >= pSeg -> links[NAV_MAX_LINKS - 1].cost)
+            return;
+        i = NAV_MAX_LINKS - 1;
+    }
+
+    // Insertion sort by cost
+    while (i > 0 && pSeg -> links[i - 1].cost > pLink -> cost) {
+        pSeg -> links[i] = pSeg -> links[i - 1];
+        i--;
+    }
+    pSeg -> links[i] = * pLink;
+}
+
+/**
+ * Adds the link for walking off one end of a segment, if there is one
+ *
+ * Parameters:
+ * pSeg			Segment to walk off
+ * cx			Sub-tile column just past the end
+ */
+static void linkFall(NAVSEG * pSeg, int cx) {
+    NAVLINK link;
+    int row;
+    int i;
+    int nHazard = 0;
+
+    if (cx < 0 || cx >= g_nCollisionW)
+        return;
+
+    // A wall, not a drop
+    for (i = 0; i <= NAV_CLEARANCE; i++)
+        if (collisionSubTile(cx, pSeg -> row - i))
+            return;
+
+    for (row = pSeg -> row + 1; row < g_nCollisionH; row++) {
+        if (spikeSubTile(cx, row - 1))
+            nHazard = NAV_HAZARD;
+
+        if (collisionSubTile(cx, row)) {
+            link.target = navSegmentAt(cx, row);
+            if (link.target < 0)
+                return;
+
+            link.fromx = pSeg -> x0 > cx ? pSeg -> x0 : pSeg -> x1;
+            link.tox = cx;
+            link.cost = navFallTicks((row - pSeg -> row) << SUBTILE_SHIFT);
+            link.type = NAV_FALL | nHazard;
+            addLink(pSeg, & link);
+            return;
+        }
+    }
+
+    // Falls off the bottom of the map
+}
+
+/**
+ * Adds the link for jumping from one segment onto another, if possible
+ *
+ * Parameters:
+ * pSeg			Segment to jump from
+ * nTarget		Segment to land on
+ */
+static void linkJump(NAVSEG * pSeg, int nTarget) {
+    NAVSEG * pDst = & g_pNavSegs[nTarget];
+    NAVLINK link;
+    int nRise = (pSeg -> row - pDst -> row) << SUBTILE_SHIFT;
+    int nGap;
+    int nTicks;
+    int nTop;
+
+    if (pDst -> x0 > pSeg -> x1) { // Target to the right
+        link.fromx = pSeg -> x1;
+        link.tox = pDst -> x0;
+    } else if (pDst -> x1 < pSeg -> x0) { // Target to the left
+        link.fromx = pSeg -> x0;
+        link.tox = pDst -> x1;
+    } else if (nRise > 0) { // Target straight above, jumps pass up through platforms
+        link.fromx = pSeg -> x0 > pDst -> x0 ? pSeg -> x0 : pDst -> x0;
+        link.tox = link.fromx;
+    } else {
+        return;
+    }
+
+    nTicks = navJumpTicks(nRise);
+    if (nTicks < 0)
+        return;
+
+    nGap = abs(link.tox - link.fromx) << SUBTILE_SHIFT;
+    if (nGap > nTicks * NAV_WALK_SPEED)
+        return;
+
+    // Walls stop sideways movement, check at the height of the higher surface
+    nTop = (pSeg -> row < pDst -> row ? pSeg -> row : pDst -> row) << SUBTILE_SHIFT;
+    if (!lineOfSight((link.fromx << SUBTILE_SHIFT) + SUBTILE_SIZE / 2, nTop - 1,
+            (link.tox << SUBTILE_SHIFT) + SUBTILE_SIZE / 2, nTop - 1))
+        return;
+
+    link.target = nTarget;
+    link.cost = nTicks;
+    link.type = NAV_JUMP | (pDst -> hazard ? NAV_HAZARD : 0);
+    addLink(pSeg, & link);
+}
+
+/**
+ * Recomputes all outgoing links of a segment
+ *
+ * Parameters:
+ * nSeg			Segment to link
+ */
+static void linkSegment(int nSeg) {
+    NAVSEG * pSeg = & g_pNavSegs[nSeg];
+    int i;
+
+    pSeg -> nlinks = 0;
+
+    linkFall(pSeg, pSeg -> x0 - 1);
+    linkFall(pSeg, pSeg -> x1 + 1);
+
+    for (i = 0; i < g_nNavSegs; i++) {
+        if (i == nSeg || !g_pNavSegs[i].alive)
+            continue;
+
+        // Out of reach horizontally
+        if (g_pNavSegs[i].x0 > pSeg -> x1 + s_nReach || g_pNavSegs[i].x1 < pSeg -> x0 - s_nReach)
+            continue;
+
+        linkJump(pSeg, i);
+    }
+}
+
+/**
+ * Builds the platform graph from the collision plane, call after
+ * collisionBuild
+ */
+int navBuild(void) {
+    int row, i;
+
+    navFree();
+
+    if (g_pCollision == NULL || buildArc())
+        return -1;
+
+    s_pSegAt = malloc(g_nCollisionW * g_nCollisionH * sizeof(short));
+    if (s_pSegAt == NULL)
+        return -1;
+    memset(s_pSegAt, 0xff, g_nCollisionW * g_nCollisionH * sizeof(short));
+
+    for (row = 0; row < g_nCollisionH; row++)
+        if (extractRow(row, 0, g_nCollisionW - 1))
+            return -1;
+
+    for (i = 0; i < g_nNavSegs; i++)
+        linkSegment(i);
+
+    g_nNavVersion++;
+    return 0;
+}
+
+/**
+ * Frees the platform graph
+ */
+void navFree(void) {
+    free(g_pNavSegs);
+    free(s_pSegAt);
+    free(s_pFree);
+    free(s_pArc);
+
+    g_pNavSegs = NULL;
+    s_pSegAt = NULL;
+    s_pFree = NULL;
+    s_pArc = NULL;
+
+    g_nNavSegs = 0;
+    s_nSegCap = 0;
+    s_nFree = 0;
+    s_nArc = 0;
+}
+
+/**
+ * Patches the graph after the solidity of one tile has changed
+ *
+ * Parameters:
+ * tx			Tile column
+ * ty			Tile row
+ */
+void navPatch(int tx, int ty) {
+    int lo = tx * 2 - 1;
+    int hi = tx * 2 + 2;
+    int nLo, nHi;
+    int row, cx, i;
+    int nSeg;
+
+    if (s_pSegAt == NULL)
+        return;
+
+    if (lo < 0)
+        lo = 0;
+    if (hi >= g_nCollisionW)
+        hi = g_nCollisionW - 1;
+
+    nLo = lo;
+    nHi = hi;
+
+    // Surfaces on the tile and the headroom rows above it are affected
+    for (row = ty * 2; row <= ty * 2 + 1 + NAV_CLEARANCE && row < g_nCollisionH; row++) {
+        int nRowLo = lo;
+        int nRowHi = hi;
+
+        // Drop the segments touching the changed columns
+        for (cx = lo; cx <= hi; cx++) {
+            nSeg = navSegmentAt(cx, row);
+            if (nSeg < 0)
+                continue;
+
+            if (g_pNavSegs[nSeg].x0 < nRowLo)
+                nRowLo = g_pNavSegs[nSeg].x0;
+            if (g_pNavSegs[nSeg].x1 > nRowHi)
+                nRowHi = g_pNavSegs[nSeg].x1;
+
+            for (i = g_pNavSegs[nSeg].x0; i <= g_pNavSegs[nSeg].x1; i++)
+                s_pSegAt[row * g_nCollisionW + i] = -1;
+
+            g_pNavSegs[nSeg].alive = 0;
+            g_pNavSegs[nSeg].nlinks = 0;
+            s_pFree[s_nFree++] = nSeg;
+        }
+
+        // Extract them again over the same span
+        extractRow(row, nRowLo, nRowHi);
+
+        if (nRowLo < nLo)
+            nLo = nRowLo;
+        if (nRowHi > nHi)
+            nHi = nRowHi;
+    }
+
+    // Relink everything that could reach or be reached from the span
+    for (i = 0; i < g_nNavSegs; i++) {
+        if (!g_pNavSegs[i].alive)
+            continue;
+
+        if (g_pNavSegs[i].x0 > nHi + s_nReach || g_pNavSegs[i].x1 < nLo - s_nReach)
+            continue;
+
+        linkSegment(i);
+    }
+
+    g_nNavVersion++;
+}
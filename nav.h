@@ -0,0 +1,66 @@
+/**
+ * File:        nav.h
+ * Purpose:     Header file for nav.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _NAV_H_
+#define _NAV_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Most links kept per platform segment, cheapest first
+#define NAV_MAX_LINKS 16
+
+// Sub-tiles of headroom needed above a walkable surface (42 pixel sprites)
+#define NAV_CLEARANCE 3
+
+// Link types, NAV_HAZARD may be combined with either
+#define NAV_FALL 1
+#define NAV_JUMP 2
+#define NAV_HAZARD 4
+
+// Horizontal speed of a walking or jumping actor, in pixels per tick
+#define NAV_WALK_SPEED 3
+
+// Move from one segment to another
+typedef struct NAVLINK
+{
+	short target;
+	short fromx, tox;
+	short cost;
+	unsigned char type;
+} NAVLINK;
+
+// Walkable platform segment, a run of sub-tiles on top of a solid surface
+typedef struct NAVSEG
+{
+	short row;
+	short x0, x1;
+	unsigned char alive;
+	unsigned char hazard;
+	unsigned char nlinks;
+	NAVLINK links[NAV_MAX_LINKS];
+} NAVSEG;
+
+// Platform graph, rebuilt after each map load
+extern NAVSEG * g_pNavSegs;
+extern int g_nNavSegs;
+extern int g_nNavVersion;
+
+// Function declarations
+int navBuild(void);
+void navFree(void);
+void navPatch(int tx, int ty);
+int navSegmentAt(int cx, int row);
+int navSegmentBelow(int x, int y);
+int navJumpTicks(int rise);
+int navFallTicks(int drop);
+
+#endif
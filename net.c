@@ -0,0 +1,260 @@
+/**
+ * File:        net.c
+ * Purpose:     UDP link to a single peer, with simulated latency and loss
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "net.h"
+#include "pace.h"
+
+#ifdef _WIN32
+typedef SOCKET NETSOCKET;
+typedef int socklen_t;
+#define closesocket_ closesocket
+#else
+typedef int NETSOCKET;
+#define INVALID_SOCKET (-1)
+#define closesocket_ close
+#endif
+
+/**
+ * Returns a pseudo-random number from 0 to nRange - 1, from the link's
+ * own seed so runs can be repeated
+ *
+ * Parameters:
+ * pLink		Link whose seed to use
+ * nRange		Number of possible values
+ */
+static int netRandom(NETLINK * pLink, int nRange) {
+    pLink -> seed = pLink -> seed * 1103515245u + 12345u;
+    return (int)((pLink -> seed >> 16) % (unsigned int) nRange);
+}
+
+/**
+ * Opens a UDP socket on a local port for talking to one peer. Returns
+ * NULL on failure.
+ *
+ * Parameters:
+ * nPort		Local port to receive on
+ * szPeer		Address of the peer, dotted
+ * nPeerPort	Port of the peer
+ */
+NETLINK * netOpen(int nPort, const char * szPeer, int nPeerPort) {
+    NETLINK * pLink;
+    NETSOCKET nSock;
+    struct sockaddr_in sAddr;
+#ifdef _WIN32
+    WSADATA sData;
+    u_long nNonBlocking = 1;
+
+    if (WSAStartup(MAKEWORD(2, 2), & sData) != 0)
+        return NULL;
+#endif
+
+    nSock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (nSock == INVALID_SOCKET)
+        return NULL;
+
+    memset( & sAddr, 0, sizeof(sAddr));
+    sAddr.sin_family = AF_INET;
+    sAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    sAddr.sin_port = htons((unsigned short) nPort);
+
+    // Never wait for packets, the game loop polls
+#ifdef _WIN32
+    if (bind(nSock, (struct sockaddr * ) & sAddr, sizeof(sAddr)) != 0 || ioctlsocket(nSock, FIONBIO, & nNonBlocking) != 0) {
+#else
+    if (bind(nSock, (struct sockaddr * ) & sAddr, sizeof(sAddr)) != 0 || fcntl(nSock, F_SETFL, O_NONBLOCK) != 0) {
+#endif
+        closesocket_(nSock);
+        return NULL;
+    }
+
+    pLink = calloc(1, sizeof(NETLINK));
+    if (pLink == NULL) {
+        closesocket_(nSock);
+        return NULL;
+    }
+
+    pLink -> held = malloc(NET_HELD_MAX * sizeof(NETHELD));
+    if (pLink -> held == NULL) {
+        closesocket_(nSock);
+        free(pLink);
+        return NULL;
+    }
+
+    pLink -> sock = (long) nSock;
+    pLink -> peeraddr = inet_addr(szPeer);
+    pLink -> peerport = htons((unsigned short) nPeerPort);
+    pLink -> seed = 1;
+
+    return pLink;
+}
+
+/**
+ * Closes a link, dropping whatever it still held back
+ *
+ * Parameters:
+ * pLink		Link to close, may be NULL
+ */
+void netClose(NETLINK * pLink) {
+    if (pLink == NULL)
+        return;
+
+    closesocket_((NETSOCKET) pLink -> sock);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    free(pLink -> held);
+    free(pLink);
+}
+
+/**
+ * Sets the conditions to simulate on packets sent over a link
+ *
+ * Parameters:
+ * pLink		Link to make worse
+ * dLatencyMs	Delay added to each packet, in milliseconds
+ * dJitterMs	Most extra delay, spread evenly, in milliseconds
+ * nLossPercent	Share of packets dropped
+ * nSeed		Seed for which packets are dropped or delayed
+ */
+void netSimulate(NETLINK * pLink, double dLatencyMs, double dJitterMs, int nLossPercent, unsigned int nSeed) {
+    pLink -> latency = dLatencyMs * 1e3;
+    pLink -> jitter = dJitterMs * 1e3;
+    pLink -> loss = nLossPercent;
+    pLink -> seed = nSeed;
+}
+
+/**
+ * Puts a packet on the wire
+ *
+ * Parameters:
+ * pLink		Link to send on
+ * pData		Packet
+ * nSize		Size of the packet
+ */
+static void netWire(NETLINK * pLink, const void * pData, int nSize) {
+    struct sockaddr_in sAddr;
+
+    memset( & sAddr, 0, sizeof(sAddr));
+    sAddr.sin_family = AF_INET;
+    sAddr.sin_addr.s_addr = pLink -> peeraddr;
+    sAddr.sin_port = pLink -> peerport;
+
+    sendto((NETSOCKET) pLink -> sock, pData, nSize, 0, (struct sockaddr * ) & sAddr, sizeof(sAddr));
+}
+
+/**
+ * Sends a packet to the peer, dropped or held back as the simulated
+ * conditions say. Returns -1 if the packet is too large.
+ *
+ * Parameters:
+ * pLink		Link to send on
+ * pData		Packet
+ * nSize		Size of the packet
+ */
+int netSend(NETLINK * pLink, const void * pData, int nSize) {
+    NETHELD * pHeld;
+
+    if (nSize > NET_PACKET_MAX)
+        return -1;
+
+    pLink -> sent++;
+
+    if (pLink -> loss > 0 && netRandom(pLink, 100) < pLink -> loss) {
+        pLink -> lost++;
+        return 0;
+    }
+
+    if (pLink -> latency <= 0 && pLink -> jitter <= 0) {
+        netWire(pLink, pData, nSize);
+        return 0;
+    }
+
+    // Nowhere to hold it, the link is too slow for the rate sent at
+    if (pLink -> nheld == NET_HELD_MAX) {
+        pLink -> overflow++;
+        return 0;
+    }
+
+    pHeld = & pLink -> held[pLink -> nheld++];
+    pHeld -> due = paceNow() + pLink -> latency;
+    if (pLink -> jitter > 0)
+        pHeld -> due += netRandom(pLink, (int) pLink -> jitter + 1);
+    pHeld -> size = nSize;
+    memcpy(pHeld -> data, pData, nSize);
+
+    netFlush(pLink);
+
+    return 0;
+}
+
+/**
+ * Puts the held back packets whose time has come on the wire. Jitter can
+ * let a later packet go before an earlier one, as on a real network.
+ *
+ * Parameters:
+ * pLink		Link to flush
+ */
+void netFlush(NETLINK * pLink) {
+    double dNow = paceNow();
+    int i, n = 0;
+
+    for (i = 0; i < pLink -> nheld; i++) {
+        if (pLink -> held[i].due <= dNow)
+            netWire(pLink, pLink -> held[i].data, pLink -> held[i].size);
+        else if (n++ != i)
+            pLink -> held[n - 1] = pLink -> held[i];
+    }
+
+    pLink -> nheld = n;
+}
+
+/**
+ * Takes the next packet received from the peer, without waiting. Returns
+ * its size, 0 if there is none.
+ *
+ * Parameters:
+ * pLink		Link to receive on
+ * pBuf			Receives the packet
+ * nCap			Size of the buffer
+ */
+int netRecv(NETLINK * pLink, void * pBuf, int nCap) {
+    struct sockaddr_in sAddr;
+    socklen_t nAddr;
+    int nSize;
+
+    netFlush(pLink);
+
+    // Anything not from the peer is ignored
+    for (;;) {
+        nAddr = sizeof(sAddr);
+        nSize = recvfrom((NETSOCKET) pLink -> sock, pBuf, nCap, 0, (struct sockaddr * ) & sAddr, & nAddr);
+        if (nSize <= 0)
+            return 0;
+
+        if (sAddr.sin_addr.s_addr == pLink -> peeraddr && sAddr.sin_port == pLink -> peerport) {
+            pLink -> received++;
+            return nSize;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * File:        net.h
+ * Purpose:     Header file for net.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _NET_H_
+#define _NET_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Largest packet sent or received
+#define NET_PACKET_MAX 512
+
+// Packets held back to simulate latency
+#define NET_HELD_MAX 256
+
+// A packet waiting for its simulated latency to pass
+typedef struct NETHELD
+{
+	double due;
+	int size;
+	unsigned char data[NET_PACKET_MAX];
+} NETHELD;
+
+// UDP socket talking to one peer, which can make the link worse than it
+// is to test with: packets sent are delayed and some are dropped
+typedef struct NETLINK
+{
+	long sock;
+	unsigned long peeraddr;
+	unsigned short peerport;
+
+	// Simulated conditions, delay in microseconds each way
+	double latency;
+	double jitter;
+	int loss;
+	unsigned int seed;
+
+	// Packets held back, in the order they were sent
+	NETHELD * held;
+	int nheld;
+
+	// Totals, for measuring
+	long sent;
+	long lost;
+	long received;
+	long overflow;
+} NETLINK;
+
+// Function declarations
+NETLINK * netOpen(int nPort, const char * szPeer, int nPeerPort);
+void netClose(NETLINK * pLink);
+void netSimulate(NETLINK * pLink, double dLatencyMs, double dJitterMs, int nLossPercent, unsigned int nSeed);
+int netSend(NETLINK * pLink, const void * pData, int nSize);
+void netFlush(NETLINK * pLink);
+int netRecv(NETLINK * pLink, void * pBuf, int nCap);
+
+#endif
@@ -0,0 +1,263 @@
+/**
+ * File:        netplay.c
+ * Purpose:     Plays a two-player game against another copy of itself over
+ *              UDP, with scripted players, and checks that both copies end
+ *              up with the same game
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "sim.h"
+#include "pace.h"
+#include "net.h"
+#include "rollback.h"
+
+// Ticks to play when none are given
+#define DEFAULT_TICKS 3600
+
+// Microseconds to wait for the peer to show up, and for it to finish
+#define CONNECT_TIMEOUT 30e6
+#define FINISH_TIMEOUT 10e6
+
+// Microseconds to keep answering the peer once both sides are done
+#define FINISH_LINGER 500e3
+
+/**
+ * Decides on input for a scripted player: run right, jump when stuck or
+ * every so often, each player on its own beat, and restart when the game
+ * is over
+ *
+ * Parameters:
+ * nPlayer		Slot of the player
+ * nTick		Current tick
+ */
+static int botInput(int nPlayer, long nTick) {
+    int nInput = INPUT_RIGHT;
+
+    if (!g_sActors.alive[nPlayer])
+        return nInput | INPUT_RESTART;
+
+    if (g_sActors.x[nPlayer] == g_sActors.oldx[nPlayer] || nTick % (45 + 14 * nPlayer) == 0)
+        nInput |= INPUT_JUMP;
+
+    return nInput;
+}
+
+/**
+ * Takes in every packet waiting, then sends one
+ *
+ * Parameters:
+ * pLink		Link to the peer
+ * pRollback	Game
+ */
+static void pump(NETLINK * pLink, ROLLBACK * pRollback) {
+    unsigned char aPacket[NET_PACKET_MAX];
+    int nSize;
+
+    while ((nSize = netRecv(pLink, aPacket, sizeof(aPacket))) > 0)
+        rollbackReceive(pRollback, aPacket, nSize);
+
+    nSize = rollbackPacket(pRollback, aPacket, ROLLBACK_PACKET_MAX);
+    netSend(pLink, aPacket, nSize);
+}
+
+/**
+ * Plays the confirmed inputs again from the start, without rollback, and
+ * counts the ticks that do not end in the same state
+ *
+ * Parameters:
+ * pInputs		Input of every tick
+ * pSums		Checksum after every tick, as played online
+ * nTicks		Number of ticks
+ */
+static long replayInputs(const int * pInputs, const unsigned int * pSums, long nTicks) {
+    long nFailed = 0;
+    long t;
+
+    simPlayers(2);
+    for (t = 0; t < nTicks; t++) {
+        simTick(pInputs[t]);
+        if (simChecksum() != pSums[t] && nFailed++ == 0)
+            printf("Offline play differs from tick %ld\n", t);
+    }
+
+    return nFailed;
+}
+
+/**
+ * Runs the program
+ *
+ * Parameters:
+ * argc			Number of arguments
+ * argv			Arguments
+ */
+int main(int argc, char * argv[]) {
+    const char * szMap = "map.fmp";
+    const char * szPeer = "127.0.0.1";
+    double dLatency = 0, dJitter = 0;
+    int nLoss = 0;
+    int nDelay = 2;
+    int nPlayer, nPort, nPeerPort;
+    long nTicks = DEFAULT_TICKS;
+    int nArg = 1;
+    NETLINK * pLink;
+    ROLLBACK * pRollback;
+    PACER sPacer;
+    unsigned char aPacket[NET_PACKET_MAX];
+    int * pInputs;
+    unsigned int * pSums;
+    long nLogged = 0;
+    long nFailed;
+    double dStart, dDone = 0;
+    int nSize;
+    int nResult = 0;
+
+    // Options first, then the positional arguments
+    for (; nArg + 1 < argc && argv[nArg][0] == '-'; nArg++) {
+        if (!strcmp(argv[nArg], "-latency"))
+            dLatency = atof(argv[++nArg]);
+        else if (!strcmp(argv[nArg], "-jitter"))
+            dJitter = atof(argv[++nArg]);
+        else if (!strcmp(argv[nArg], "-loss"))
+            nLoss = atoi(argv[++nArg]);
+        else if (!strcmp(argv[nArg], "-delay"))
+            nDelay = atoi(argv[++nArg]);
+        else if (!strcmp(argv[nArg], "-peer"))
+            szPeer = argv[++nArg];
+        else
+            nArg++;
+    }
+
+    if (argc - nArg < 3) {
+        fprintf(stderr, "Usage: netplay [-latency ms] [-jitter ms] [-loss percent] [-delay ticks] [-peer address]\n"
+            "               player port peerport [map] [ticks]\n");
+        return 1;
+    }
+
+    nPlayer = atoi(argv[nArg++]) == RIVAL ? RIVAL : PLAYER;
+    nPort = atoi(argv[nArg++]);
+    nPeerPort = atoi(argv[nArg++]);
+    if (nArg < argc)
+        szMap = argv[nArg++];
+    if (nArg < argc)
+        nTicks = atol(argv[nArg]);
+
+    if (simInit(szMap) != 0) {
+        fprintf(stderr, "Error loading map %s\n", szMap);
+        return 1;
+    }
+
+    pLink = netOpen(nPort, szPeer, nPeerPort);
+    if (pLink == NULL) {
+        fprintf(stderr, "Error opening port %d\n", nPort);
+        simShutdown();
+        return 1;
+    }
+    netSimulate(pLink, dLatency, dJitter, nLoss, 1 + nPlayer);
+
+    pRollback = rollbackCreate(nPlayer, nDelay);
+    pInputs = malloc(nTicks * sizeof(int));
+    pSums = malloc(nTicks * sizeof(unsigned int));
+    if (pRollback == NULL || pInputs == NULL || pSums == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    simPlayers(2);
+
+    // Wait for the peer, saying hello until it answers
+    dStart = paceNow();
+    while (pLink -> received == 0) {
+        if (paceNow() - dStart > CONNECT_TIMEOUT) {
+            fprintf(stderr, "No answer from %s:%d\n", szPeer, nPeerPort);
+            return 1;
+        }
+
+        nSize = rollbackPacket(pRollback, aPacket, ROLLBACK_PACKET_MAX);
+        netSend(pLink, aPacket, nSize);
+        paceSleep(10e3);
+
+        while ((nSize = netRecv(pLink, aPacket, sizeof(aPacket))) > 0)
+            rollbackReceive(pRollback, aPacket, nSize);
+    }
+
+    printf("Player %d on port %d, peer %s:%d, latency %.0f ms, jitter %.0f ms, loss %d%%, delay %d ticks\n",
+        nPlayer, nPort, szPeer, nPeerPort, dLatency, dJitter, nLoss, pRollback -> delay);
+
+    // Play at the game's rate until both sides know every input, and a
+    // little longer so the peer hears that
+    paceStart( & sPacer, "netplay", 1e6 / TICK_RATE);
+    dStart = paceNow();
+    for (;;) {
+        paceWait( & sPacer);
+
+        pump(pLink, pRollback);
+
+        if (pRollback -> frame < nTicks) {
+            if (rollbackAdvance(pRollback, botInput(nPlayer, pRollback -> frame)) < 0) {
+                fprintf(stderr, "Lost the state to roll back to at tick %ld\n", pRollback -> frame);
+                nResult = 1;
+                break;
+            }
+        } else {
+            rollbackCorrect(pRollback);
+        }
+
+        // Keep what can no longer change, before the history moves on
+        for (; nLogged < rollbackConfirmed(pRollback) && nLogged < nTicks; nLogged++) {
+            pInputs[nLogged] = rollbackInput(pRollback, nLogged);
+            pSums[nLogged] = rollbackChecksum(pRollback, nLogged);
+        }
+
+        if (nLogged == nTicks && pRollback -> remoteacked >= pRollback -> localknown) {
+            if (dDone == 0)
+                dDone = paceNow();
+            else if (paceNow() - dDone > FINISH_LINGER)
+                break;
+        }
+
+        if (paceNow() - dStart > nTicks * 1e6 / TICK_RATE + FINISH_TIMEOUT) {
+            fprintf(stderr, "Gave up waiting for the peer at tick %ld of %ld\n", nLogged, nTicks);
+            nResult = 1;
+            break;
+        }
+    }
+
+    printf("Played %ld ticks in %.2f s, final checksum %08x\n", pRollback -> frame,
+        (paceNow() - dStart) / 1e6, nLogged > 0 ? pSums[nLogged - 1] : 0);
+    printf("Rollbacks: %ld, %ld ticks played again, deepest %ld, %.1f us per tick played again\n",
+        pRollback -> rollbacks, pRollback -> resimulated, pRollback -> deepest,
+        pRollback -> resimulated > 0 ? pRollback -> resimtime / pRollback -> resimulated : 0.0);
+    printf("Snapshots: %.1f us to save, %.1f us to load\n",
+        pRollback -> saves > 0 ? pRollback -> savetime / pRollback -> saves : 0.0,
+        pRollback -> loads > 0 ? pRollback -> loadtime / pRollback -> loads : 0.0);
+    printf("Peer input: %ld guessed right, %ld guessed wrong, %ld stalls, %ld waits to let the peer catch up\n",
+        pRollback -> predicted, pRollback -> mispredicted, pRollback -> stalls, pRollback -> waits);
+    printf("Packets: %ld sent, %ld lost on purpose, %ld received\n", pLink -> sent, pLink -> lost, pLink -> received);
+    paceReport( & sPacer, stdout);
+
+    if (pRollback -> desyncs > 0) {
+        printf("Desynced from the peer %ld times, first at tick %ld\n", pRollback -> desyncs, pRollback -> firstdesync);
+        nResult = 1;
+    } else {
+        printf("In step with the peer up to tick %ld\n", pRollback -> checked);
+    }
+
+    nFailed = replayInputs(pInputs, pSums, nLogged);
+    printf("Offline play of the confirmed inputs: %ld of %ld ticks differ\n", nFailed, nLogged);
+    if (nFailed > 0)
+        nResult = 1;
+
+    free(pInputs);
+    free(pSums);
+    rollbackFree(pRollback);
+    netClose(pLink);
+    simShutdown();
+
+    return nResult;
+}
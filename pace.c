@@ -0,0 +1,220 @@
+/**
+ * File:        pace.c
+ * Purpose:     Frame pacing on a monotonic clock, sleeping rather than
+ *              busy-waiting for all but the last moments of a frame
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <math.h>
+#include <sched.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include "pace.h"
+
+/**
+ * Returns microseconds on a clock that only ever goes forward, from an
+ * arbitrary start
+ */
+double paceNow(void) {
+#ifdef _WIN32
+    static double dScale = 0;
+    LARGE_INTEGER nCount;
+
+    if (dScale == 0) {
+        QueryPerformanceFrequency( & nCount);
+        dScale = 1e6 / (double) nCount.QuadPart;
+    }
+
+    QueryPerformanceCounter( & nCount);
+    return (double) nCount.QuadPart * dScale;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, & ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+#endif
+}
+
+/**
+ * Gives the processor up for about the given time, likely a little more
+ *
+ * Parameters:
+ * dMicros		Microseconds to sleep
+ */
+void paceSleep(double dMicros) {
+#ifdef _WIN32
+    if (dMicros >= 1000)
+        Sleep((DWORD)(dMicros / 1000));
+#else
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(dMicros / 1e6);
+    ts.tv_nsec = (long)((dMicros - ts.tv_sec * 1e6) * 1e3);
+    nanosleep( & ts, NULL);
+#endif
+}
+
+/**
+ * Starts pacing a loop, its first frame is due at once
+ *
+ * Parameters:
+ * pPacer		Pacer to start
+ * szName		Shown when logging missed deadlines
+ * dPeriod		Microseconds from one frame to the next
+ */
+void paceStart(PACER * pPacer, const char * szName, double dPeriod) {
+    pPacer -> name = szName;
+    pPacer -> period = dPeriod;
+    pPacer -> start = paceNow();
+    pPacer -> next = pPacer -> start;
+    pPacer -> last = pPacer -> start;
+    pPacer -> slack = PACE_SLACK_US;
+
+    pPacer -> frames = 0;
+    pPacer -> missed = 0;
+    pPacer -> sum = 0;
+    pPacer -> sumsq = 0;
+    pPacer -> worst = 0;
+    pPacer -> slept = 0;
+    pPacer -> spun = 0;
+
+    pPacer -> logged = pPacer -> start;
+    pPacer -> logmissed = 0;
+    pPacer -> logworst = 0;
+}
+
+/**
+ * Counts a frame let through at the given time and sets the deadline of
+ * the next one. Returns how late the frame was, in microseconds.
+ *
+ * Parameters:
+ * pPacer		Pacer of the loop
+ * dNow			When the frame was let through
+ */
+static double paceCount(PACER * pPacer, double dNow) {
+    double dLate = dNow - pPacer -> next;
+    double dInterval = dNow - pPacer -> last;
+
+    if (pPacer -> frames > 0) {
+        pPacer -> sum += dInterval;
+        pPacer -> sumsq += dInterval * dInterval;
+    }
+    pPacer -> frames++;
+    pPacer -> last = dNow;
+
+    if (dLate > pPacer -> worst)
+        pPacer -> worst = dLate;
+
+    if (dLate > pPacer -> period / PACE_MISS_DIV) {
+        pPacer -> missed++;
+        pPacer -> logmissed++;
+        if (dLate > pPacer -> logworst)
+            pPacer -> logworst = dLate;
+    }
+
+    // A whole frame behind can't be made up, start over from now rather
+    // than rushing the frames after it
+    if (dLate >= pPacer -> period)
+        pPacer -> next = dNow + pPacer -> period;
+    else
+        pPacer -> next += pPacer -> period;
+
+    // Say what was missed once in a while, not on every frame
+    if (pPacer -> logmissed > 0 && dNow - pPacer -> logged >= PACE_LOG_US) {
+        fprintf(stderr, "%s: missed %ld deadlines in %.1f s, worst by %.1f ms\n", pPacer -> name,
+            pPacer -> logmissed, (dNow - pPacer -> logged) / 1e6, pPacer -> logworst / 1e3);
+        pPacer -> logged = dNow;
+        pPacer -> logmissed = 0;
+        pPacer -> logworst = 0;
+    }
+
+    return dLate;
+}
+
+/**
+ * Waits for the next frame to be due: sleeps while the deadline is
+ * further off than sleeps have lately overrun by, then spins. Returns
+ * how late the frame was let through, in microseconds.
+ *
+ * Parameters:
+ * pPacer		Pacer of the loop
+ */
+double paceWait(PACER * pPacer) {
+    double dNow = paceNow();
+    double dSleep, dWoke, dOver;
+
+    // Sleep for all but the part sleeps can't be trusted with
+    dSleep = pPacer -> next - dNow - pPacer -> slack - PACE_SPIN_MIN_US;
+    if (dSleep > 0) {
+        paceSleep(dSleep);
+        dWoke = paceNow();
+        pPacer -> slept += dWoke - dNow;
+
+        // Learn the overrun, quicker when it grows than when it shrinks,
+        // and never spin away more than half a frame for a stray one
+        dOver = dWoke - dNow - dSleep;
+        if (dOver > pPacer -> slack)
+            pPacer -> slack += (dOver - pPacer -> slack) / 4;
+        else
+            pPacer -> slack += (dOver - pPacer -> slack) / 16;
+        if (pPacer -> slack > pPacer -> period / 2)
+            pPacer -> slack = pPacer -> period / 2;
+
+        dNow = dWoke;
+    }
+
+    // Give the rest of the time slice away until the deadline
+    dWoke = dNow;
+    while (dNow < pPacer -> next) {
+        sched_yield();
+        dNow = paceNow();
+    }
+    pPacer -> spun += dNow - dWoke;
+
+    return paceCount(pPacer, dNow);
+}
+
+/**
+ * Counts a frame paced by something else, such as the retrace, without
+ * waiting. Returns how late it was against the pacer's own deadline.
+ *
+ * Parameters:
+ * pPacer		Pacer of the loop
+ */
+double paceMark(PACER * pPacer) {
+    return paceCount(pPacer, paceNow());
+}
+
+/**
+ * Prints what the pacing looked like since the pacer was started
+ *
+ * Parameters:
+ * pPacer		Pacer of the loop
+ * fp			File to print to
+ */
+void paceReport(const PACER * pPacer, FILE * fp) {
+    double dTotal = pPacer -> last - pPacer -> start;
+    double dMean = 0, dJitter = 0;
+    long n = pPacer -> frames - 1;
+
+    if (n > 0) {
+        dMean = pPacer -> sum / n;
+        dJitter = pPacer -> sumsq / n - dMean * dMean;
+        dJitter = dJitter > 0 ? sqrt(dJitter) : 0;
+    }
+
+    fprintf(fp, "%s: %ld frames, %.3f ms apart, %.3f ms jitter, %ld missed, worst %.3f ms late",
+        pPacer -> name, pPacer -> frames, dMean / 1e3, dJitter / 1e3, pPacer -> missed, pPacer -> worst / 1e3);
+    if (dTotal > 0)
+        fprintf(fp, ", asleep %.1f%%, spinning %.1f%%", pPacer -> slept * 100 / dTotal, pPacer -> spun * 100 / dTotal);
+    fprintf(fp, "\n");
+}
@@ -0,0 +1,69 @@
+/**
+ * File:        pace.h
+ * Purpose:     Header file for pace.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _PACE_H_
+#define _PACE_H_
+
+// Include C stdlib
+#include <stdio.h>
+#include <stdlib.h>
+
+// Sleeps are trusted to wake this close to time before the overrun of
+// actual sleeps is known, in microseconds
+#define PACE_SLACK_US 2000
+
+// Spin at least this long before a deadline, in microseconds
+#define PACE_SPIN_MIN_US 200
+
+// A frame this late is a missed deadline, in fractions of a frame
+#define PACE_MISS_DIV 4
+
+// Missed deadlines are logged at most this often, in microseconds
+#define PACE_LOG_US 1000000
+
+// Keeps a loop to one frame per period: sleeps most of the wait, then
+// spins for the rest, learning how late sleeps wake up on this system
+typedef struct PACER
+{
+	const char * name;
+	double period;
+
+	// Deadline of the next frame and when the last one was let through
+	double next;
+	double last;
+
+	// How late sleeps have woken up lately
+	double slack;
+
+	// Totals since the pacer was started
+	long frames;
+	long missed;
+	double start;
+	double sum, sumsq;
+	double worst;
+	double slept;
+	double spun;
+
+	// Missed deadlines not logged yet
+	double logged;
+	long logmissed;
+	double logworst;
+} PACER;
+
+// Function declarations
+double paceNow(void);
+void paceSleep(double dMicros);
+void paceStart(PACER * pPacer, const char * szName, double dPeriod);
+double paceWait(PACER * pPacer);
+double paceMark(PACER * pPacer);
+void paceReport(const PACER * pPacer, FILE * fp);
+
+#endif
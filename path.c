@@ -0,0 +1,472 @@
+/**
+ * File:        path.c
+ * Purpose:     Cached, time-sliced A* route search over the platform graph
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "path.h"
+#include "nav.h"
+#include "collide.h"
+
+// Cached route, or a cached failure
+typedef struct PATHENTRY
+{
+	int version;
+	int result;
+	PATH path;
+} PATHENTRY;
+
+// Open list entry, stale entries are skipped when popped
+typedef struct PATHNODE
+{
+	int f;
+	int seg;
+} PATHNODE;
+
+// Route cache, keyed by (from, to) and tagged with the graph version,
+// allocated on first use
+static SIM_LOCAL PATHENTRY * s_pCache = NULL;
+
+// Requests waiting for search time
+static SIM_LOCAL short s_aQueue[PATH_QUEUE_SIZE][2];
+static SIM_LOCAL int s_nQueueHead = 0;
+static SIM_LOCAL int s_nQueueLen = 0;
+
+// The search in progress, resumed across frames
+static SIM_LOCAL int s_nFrom = -1;
+static SIM_LOCAL int s_nTo = -1;
+static SIM_LOCAL int s_nVersion = 0;
+
+// Per-segment search state
+static SIM_LOCAL int * s_pG = NULL;
+static SIM_LOCAL short * s_pEntry = NULL;
+static SIM_LOCAL short * s_pParent = NULL;
+static SIM_LOCAL short * s_pParentLink = NULL;
+static SIM_LOCAL unsigned char * s_pClosed = NULL;
+static SIM_LOCAL PATHNODE * s_pHeap = NULL;
+static SIM_LOCAL int s_nHeap = 0;
+static SIM_LOCAL int s_nHeapCap = 0;
+static SIM_LOCAL int s_nNodeCap = 0;
+
+// Expansions left this frame
+static SIM_LOCAL int s_nBudget = PATH_FRAME_BUDGET;
+
+/**
+ * Finds the cache slot for a pair of segments
+ *
+ * Parameters:
+ * from			Starting segment
+ * to			Destination segment
+ */
+static PATHENTRY * cacheSlot(int from, int to) {
+    if (s_pCache == NULL) {
+        s_pCache = calloc(PATH_CACHE_SIZE, sizeof(PATHENTRY));
+        if (s_pCache == NULL)
+            return NULL;
+    }
+
+    return & s_pCache[((unsigned int) from * 31u + (unsigned int) to) % PATH_CACHE_SIZE];
+}
+
+/**
+ * Returns the cached entry for a pair of segments, or NULL if there is
+ * none for the current graph
+ *
+ * Parameters:
+ * from			Starting segment
+ * to			Destination segment
+ */
+static PATHENTRY * cacheGet(int from, int to) {
+    PATHENTRY * pEntry = cacheSlot(from, to);
+
+    if (pEntry == NULL)
+        return NULL;
+    if (pEntry -> version != g_nNavVersion || pEntry -> path.from != from || pEntry -> path.to != to)
+        return NULL;
+
+    return pEntry;
+}
+
+/**
+ * Lower bound on the ticks between two segments, actors never move
+ * sideways faster than NAV_WALK_SPEED
+ *
+ * Parameters:
+ * seg			Segment to estimate from
+ */
+static int heuristic(int seg) {
+    NAVSEG * pSeg = & g_pNavSegs[seg];
+    NAVSEG * pDst = & g_pNavSegs[s_nTo];
+    int nGap = 0;
+
+    if (pDst -> x0 > pSeg -> x1)
+        nGap = pDst -> x0 - pSeg -> x1;
+    else if (pSeg -> x0 > pDst -> x1)
+        nGap = pSeg -> x0 - pDst -> x1;
+
+    return (nGap << SUBTILE_SHIFT) / NAV_WALK_SPEED;
+}
+
+/**
+ * Pushes a segment onto the open list
+ *
+ * Parameters:
+ * seg			Segment to push
+ * f			Estimated total cost through it
+ */
+static int heapPush(int seg, int f) {
+    PATHNODE node;
+    PATHNODE * pNew;
+    int i;
+
+    if (s_nHeap == s_nHeapCap) {
+        pNew = realloc(s_pHeap, (s_nHeapCap ? s_nHeapCap * 2 : 256) * sizeof(PATHNODE));
+        if (pNew == NULL)
+            return -1;
+        s_pHeap = pNew;
+        s_nHeapCap = s_nHeapCap ? s_nHeapCap * 2 : 256;
+    }
+
+    node.f = f;
+    node.seg = seg;
+
+    // Sift up
+    i = s_nHeap++;
+    while (i > 0 && s_pHeap[(i - 1) / 2].f > f) {
+        s_pHeap[i] = s_pHeap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s_pHeap[i] = node;
+
+    return 0;
+}
+
+/**
+ * Pops the cheapest segment off the open list
+ */
+static PATHNODE heapPop(void) {
+    PATHNODE top = s_pHeap[0];
+    PATHNODE last = s_pHeap[--s_nHeap];
+    int i = 0;
+    int child;
+
+    // Sift down
+    while ((child = i * 2 + 1) < s_nHeap) {
+        if (child + 1 < s_nHeap && s_pHeap[child + 1].f < s_pHeap[child].f)
+            child++;
+        if (s_pHeap[child].f >= last.f)
+            break;
+        s_pHeap[i] = s_pHeap[child];
+        i = child;
+    }
+    if (s_nHeap > 0)
+        s_pHeap[i] = last;
+
+    return top;
+}
+
+/**
+ * Starts a new search, returns -1 if out of memory
+ *
+ * Parameters:
+ * from			Starting segment
+ * to			Destination segment
+ */
+static int searchStart(int from, int to) {
+    int nCap;
+
+    // Grow the per-segment state with the graph
+    if (g_nNavSegs > s_nNodeCap) {
+        nCap = g_nNavSegs * 2;
+
+        s_pG = realloc(s_pG, nCap * sizeof(int));
+        s_pEntry = realloc(s_pEntry, nCap * sizeof(short));
+        s_pParent = realloc(s_pParent, nCap * sizeof(short));
+        s_pParentLink = realloc(s_pParentLink, nCap * sizeof(short));
+        s_pClosed = realloc(s_pClosed, nCap);
+        if (s_pG == NULL || s_pEntry == NULL || s_pParent == NULL || s_pParentLink == NULL || s_pClosed == NULL) {
+            s_nNodeCap = 0;
+            return -1;
+        }
+
+        s_nNodeCap = nCap;
+    }
+
+    memset(s_pClosed, 0, g_nNavSegs);
+    memset(s_pG, 0x7f, g_nNavSegs * sizeof(int));
+
+    s_nFrom = from;
+    s_nTo = to;
+    s_nVersion = g_nNavVersion;
+    s_nHeap = 0;
+
+    s_pG[from] = 0;
+    s_pEntry[from] = -1;
+    s_pParent[from] = -1;
+    s_pParentLink[from] = -1;
+
+    return heapPush(from, heuristic(from));
+}
+
+/**
+ * Stores the result of the current search in the cache
+ *
+ * Parameters:
+ * result		PATH_FOUND or PATH_NONE
+ */
+static void searchFinish(int result) {
+    PATHENTRY * pEntry = cacheSlot(s_nFrom, s_nTo);
+    int nSteps = 0;
+    int seg;
+
+    if (pEntry == NULL)
+        return;
+
+    pEntry -> version = g_nNavVersion;
+    pEntry -> path.from = s_nFrom;
+    pEntry -> path.to = s_nTo;
+    pEntry -> path.nsteps = 0;
+    pEntry -> path.cost = 0;
+    pEntry -> result = result;
+
+    if (result == PATH_FOUND) {
+        // Count the hops back to the start
+        for (seg = s_nTo; s_pParent[seg] >= 0; seg = s_pParent[seg])
+            nSteps++;
+
+        if (nSteps > PATH_MAX_STEPS) {
+            pEntry -> result = PATH_NONE;
+        } else {
+            pEntry -> path.nsteps = nSteps;
+            pEntry -> path.cost = s_pG[s_nTo];
+            for (seg = s_nTo; s_pParent[seg] >= 0; seg = s_pParent[seg]) {
+                nSteps--;
+                pEntry -> path.steps[nSteps].seg = s_pParent[seg];
+                pEntry -> path.steps[nSteps].link = s_pParentLink[seg];
+            }
+        }
+    }
+
+    s_nFrom = -1;
+    s_nTo = -1;
+}
+
+/**
+ * Runs the current search until it ends or the frame budget is spent
+ */
+static void searchRun(void) {
+    PATHNODE node;
+    NAVSEG * pSeg;
+    NAVLINK * pLink;
+    int nWalk;
+    int g;
+    int i;
+
+    while (s_nBudget > 0) {
+        if (s_nHeap == 0) {
+            searchFinish(PATH_NONE);
+            return;
+        }
+
+        node = heapPop();
+        if (s_pClosed[node.seg])
+            continue;
+
+        if (node.seg == s_nTo) {
+            searchFinish(PATH_FOUND);
+            return;
+        }
+
+        s_pClosed[node.seg] = 1;
+        s_nBudget--;
+
+        pSeg = & g_pNavSegs[node.seg];
+        for (i = 0; i < pSeg -> nlinks; i++) {
+            pLink = & pSeg -> links[i];
+
+            // Walk along the segment to the link, then take it
+            nWalk = s_pEntry[node.seg] < 0 ? 0 : abs(pLink -> fromx - s_pEntry[node.seg]);
+            g = s_pG[node.seg] + (nWalk << SUBTILE_SHIFT) / NAV_WALK_SPEED + pLink -> cost;
+
+            // Avoid spikes unless there is no other way
+            if (pLink -> type & NAV_HAZARD)
+                g += PATH_HAZARD_COST;
+
+            if (s_pClosed[pLink -> target] || g >= s_pG[pLink -> target])
+                continue;
+
+            s_pG[pLink -> target] = g;
+            s_pEntry[pLink -> target] = pLink -> tox;
+            s_pParent[pLink -> target] = node.seg;
+            s_pParentLink[pLink -> target] = i;
+
+            if (heapPush(pLink -> target, g + heuristic(pLink -> target))) {
+                searchFinish(PATH_NONE);
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * Spends the remaining frame budget on queued requests
+ */
+void pathUpdate(void) {
+    int from, to;
+
+    // The graph changed under the search, start it again
+    if (s_nFrom >= 0 && s_nVersion != g_nNavVersion) {
+        if (searchStart(s_nFrom, s_nTo))
+            s_nFrom = -1;
+    }
+
+    while (s_nBudget > 0) {
+        if (s_nFrom < 0) {
+            if (s_nQueueLen == 0)
+                return;
+
+            from = s_aQueue[s_nQueueHead][0];
+            to = s_aQueue[s_nQueueHead][1];
+            s_nQueueHead = (s_nQueueHead + 1) % PATH_QUEUE_SIZE;
+            s_nQueueLen--;
+
+            if (cacheGet(from, to) != NULL || from >= g_nNavSegs || to >= g_nNavSegs)
+                continue;
+
+            if (searchStart(from, to))
+                return;
+        }
+
+        searchRun();
+    }
+}
+
+/**
+ * Resets the search budget, call once per frame
+ */
+void pathFrame(void) {
+    s_nBudget = PATH_FRAME_BUDGET;
+}
+
+/**
+ * Requests a route between two platform segments. Returns PATH_FOUND
+ * with the route filled in, PATH_NONE if there is no route, or
+ * PATH_PENDING if the search needs more frames; ask again next frame.
+ *
+ * Parameters:
+ * from			Starting segment
+ * to			Destination segment
+ * pPath		Receives the route
+ */
+int pathFind(int from, int to, PATH * pPath) {
+    PATHENTRY * pEntry;
+    int i;
+
+    if (from < 0 || to < 0 || from >= g_nNavSegs || to >= g_nNavSegs ||
+        !g_pNavSegs[from].alive || !g_pNavSegs[to].alive)
+        return PATH_NONE;
+
+    if (from == to) {
+        pPath -> from = from;
+        pPath -> to = to;
+        pPath -> nsteps = 0;
+        pPath -> cost = 0;
+        return PATH_FOUND;
+    }
+
+    pEntry = cacheGet(from, to);
+
+    if (pEntry == NULL) {
+        // Queue the request unless it is already waiting or running
+        if (!(s_nFrom == from && s_nTo == to)) {
+            for (i = 0; i < s_nQueueLen; i++) {
+                if (s_aQueue[(s_nQueueHead + i) % PATH_QUEUE_SIZE][0] == from &&
+                    s_aQueue[(s_nQueueHead + i) % PATH_QUEUE_SIZE][1] == to)
+                    break;
+            }
+
+            if (i == s_nQueueLen) {
+                if (s_nQueueLen == PATH_QUEUE_SIZE)
+                    return PATH_PENDING;
+
+                s_aQueue[(s_nQueueHead + s_nQueueLen) % PATH_QUEUE_SIZE][0] = from;
+                s_aQueue[(s_nQueueHead + s_nQueueLen) % PATH_QUEUE_SIZE][1] = to;
+                s_nQueueLen++;
+            }
+        }
+
+        // Cheap searches finish within the same frame
+        pathUpdate();
+
+        pEntry = cacheGet(from, to);
+        if (pEntry == NULL)
+            return PATH_PENDING;
+    }
+
+    if (pEntry -> result == PATH_FOUND)
+        * pPath = pEntry -> path;
+
+    return pEntry -> result;
+}
+
+/**
+ * Frees all search state and forgets cached routes
+ */
+void pathFree(void) {
+    free(s_pG);
+    free(s_pEntry);
+    free(s_pParent);
+    free(s_pParentLink);
+    free(s_pClosed);
+    free(s_pHeap);
+
+    s_pG = NULL;
+    s_pEntry = NULL;
+    s_pParent = NULL;
+    s_pParentLink = NULL;
+    s_pClosed = NULL;
+    s_pHeap = NULL;
+
+    s_nHeap = s_nHeapCap = s_nNodeCap = 0;
+    s_nFrom = s_nTo = -1;
+    s_nQueueHead = s_nQueueLen = 0;
+
+    free(s_pCache);
+    s_pCache = NULL;
+}
+
+/**
+ * Lists the variables holding the searches of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int pathState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, s_pCache);
+    STATE_ADD(pVars, n, s_aQueue);
+    STATE_ADD(pVars, n, s_nQueueHead);
+    STATE_ADD(pVars, n, s_nQueueLen);
+    STATE_ADD(pVars, n, s_nFrom);
+    STATE_ADD(pVars, n, s_nTo);
+    STATE_ADD(pVars, n, s_nVersion);
+    STATE_ADD(pVars, n, s_pG);
+    STATE_ADD(pVars, n, s_pEntry);
+    STATE_ADD(pVars, n, s_pParent);
+    STATE_ADD(pVars, n, s_pParentLink);
+    STATE_ADD(pVars, n, s_pClosed);
+    STATE_ADD(pVars, n, s_pHeap);
+    STATE_ADD(pVars, n, s_nHeap);
+    STATE_ADD(pVars, n, s_nHeapCap);
+    STATE_ADD(pVars, n, s_nNodeCap);
+    STATE_ADD(pVars, n, s_nBudget);
+
+    return n;
+}
@@ -0,0 +1,63 @@
+/**
+ * File:        path.h
+ * Purpose:     Header file for path.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _PATH_H_
+#define _PATH_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "state.h"
+
+// Longest route, in links
+#define PATH_MAX_STEPS 64
+
+// Number of cached routes
+#define PATH_CACHE_SIZE 256
+
+// Pending requests waiting for search time
+#define PATH_QUEUE_SIZE 32
+
+// Segment expansions allowed per frame
+#define PATH_FRAME_BUDGET 512
+
+// Extra cost of a link that crosses spikes
+#define PATH_HAZARD_COST 10000
+
+// Results of a route request
+#define PATH_NONE 0
+#define PATH_FOUND 1
+#define PATH_PENDING 2
+
+// One hop of a route, taking a link out of a segment
+typedef struct PATHSTEP
+{
+	short seg;
+	short link;
+} PATHSTEP;
+
+// Route between two platform segments
+typedef struct PATH
+{
+	short from, to;
+	short nsteps;
+	int cost;
+	PATHSTEP steps[PATH_MAX_STEPS];
+} PATH;
+
+// Function declarations
+int pathFind(int from, int to, PATH * pPath);
+void pathFrame(void);
+void pathUpdate(void);
+void pathFree(void);
+int pathState(STATEVAR * pVars);
+
+#endif
@@ -0,0 +1,350 @@
+/**
+ * File:        region.c
+ * Purpose:     Spawners and the set of awake actors, bucketed by map column
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "region.h"
+#include "level.h"
+
+// Slots of the actors near the view, gathered by regionUpdate
+SIM_LOCAL int * g_pAwake = NULL;
+SIM_LOCAL int g_nAwake = 0;
+static SIM_LOCAL int s_nAwakeCap = 0;
+
+// First listed actor of each region, -1 if empty
+static SIM_LOCAL int * s_pHeads = NULL;
+static SIM_LOCAL int s_nRegions = 0;
+
+// Spawners sorted by X, with the first one of each region
+static SIM_LOCAL SPAWNER * s_pSpawners = NULL;
+static SIM_LOCAL int s_nSpawners = 0;
+static SIM_LOCAL int * s_pSpawnFirst = NULL;
+
+/**
+ * Returns the region holding an X coordinate, clamped to the map
+ *
+ * Parameters:
+ * x			X coordinate
+ */
+static int regionAt(int x) {
+    if (x < 0)
+        return 0;
+    if (x >> REGION_SHIFT >= s_nRegions)
+        return s_nRegions - 1;
+
+    return x >> REGION_SHIFT;
+}
+
+/**
+ * Orders spawners by X, then Y
+ */
+static int compareSpawners(const void * pA, const void * pB) {
+    const SPAWNER * a = pA;
+    const SPAWNER * b = pB;
+
+    if (a -> x != b -> x)
+        return a -> x < b -> x ? -1 : 1;
+    if (a -> y != b -> y)
+        return a -> y < b -> y ? -1 : 1;
+
+    return 0;
+}
+
+/**
+ * Sets up the regions of the current level and collects its spawners.
+ * Maps without spawner blocks use the given default spawners instead.
+ *
+ * Parameters:
+ * pDefault		Spawners to use if the map has none
+ * nDefault		Number of default spawners
+ */
+int regionBuild(const SPAWNER * pDefault, int nDefault) {
+    int tx, ty;
+    int i, r;
+    LEVELBLK * pBlock;
+
+    regionFree();
+
+    s_nRegions = ((g_pLevel -> width * TILE_SIZE) >> REGION_SHIFT) + 1;
+    s_pHeads = malloc(s_nRegions * sizeof(int));
+    s_pSpawnFirst = malloc((s_nRegions + 1) * sizeof(int));
+    if (s_pHeads == NULL || s_pSpawnFirst == NULL)
+        return -1;
+
+    // Count the spawner blocks first
+    for (ty = 0; ty < g_pLevel -> height; ty++)
+        for (tx = 0; tx < g_pLevel -> width; tx++)
+            if (levelGetBlock(tx, ty) -> spawn)
+                s_nSpawners++;
+
+    if (s_nSpawners == 0) {
+        s_nSpawners = nDefault;
+        s_pSpawners = malloc((nDefault ? nDefault : 1) * sizeof(SPAWNER));
+        if (s_pSpawners == NULL)
+            return -1;
+
+        memcpy(s_pSpawners, pDefault, nDefault * sizeof(SPAWNER));
+    } else {
+        s_pSpawners = malloc(s_nSpawners * sizeof(SPAWNER));
+        if (s_pSpawners == NULL)
+            return -1;
+
+        i = 0;
+        for (ty = 0; ty < g_pLevel -> height; ty++) {
+            for (tx = 0; tx < g_pLevel -> width; tx++) {
+                pBlock = levelGetBlock(tx, ty);
+                if (!pBlock -> spawn)
+                    continue;
+
+                s_pSpawners[i].x = tx * TILE_SIZE;
+                s_pSpawners[i].y = ty * TILE_SIZE;
+                s_pSpawners[i].kind = pBlock -> spawn;
+                i++;
+            }
+        }
+    }
+
+    qsort(s_pSpawners, s_nSpawners, sizeof(SPAWNER), compareSpawners);
+
+    // Index the spawners by region
+    for (r = 0, i = 0; r <= s_nRegions; r++) {
+        while (i < s_nSpawners && regionAt(s_pSpawners[i].x) < r)
+            i++;
+        s_pSpawnFirst[r] = i;
+    }
+
+    regionReset();
+
+    return 0;
+}
+
+/**
+ * Frees the regions and spawners
+ */
+void regionFree(void) {
+    free(s_pHeads);
+    free(s_pSpawnFirst);
+    free(s_pSpawners);
+    free(g_pAwake);
+
+    s_pHeads = NULL;
+    s_pSpawnFirst = NULL;
+    s_pSpawners = NULL;
+    g_pAwake = NULL;
+    s_nRegions = 0;
+    s_nSpawners = 0;
+    g_nAwake = 0;
+    s_nAwakeCap = 0;
+}
+
+/**
+ * Empties every region and rearms the spawners, for a new game on an
+ * empty actor pool
+ */
+void regionReset(void) {
+    int i;
+
+    for (i = 0; i < s_nRegions; i++)
+        s_pHeads[i] = -1;
+
+    for (i = 0; i < s_nSpawners; i++)
+        s_pSpawners[i].done = 0;
+
+    g_nAwake = 0;
+}
+
+/**
+ * Lists an actor in the region under its position
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+void regionInsert(int i) {
+    int r = regionAt(g_sActors.x[i]);
+
+    g_sActors.region[i] = r;
+    g_sActors.rprev[i] = -1;
+    g_sActors.rnext[i] = s_pHeads[r];
+    if (s_pHeads[r] >= 0)
+        g_sActors.rprev[s_pHeads[r]] = i;
+    s_pHeads[r] = i;
+}
+
+/**
+ * Takes an actor out of its region
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+void regionRemove(int i) {
+    if (g_sActors.rprev[i] >= 0)
+        g_sActors.rnext[g_sActors.rprev[i]] = g_sActors.rnext[i];
+    else
+        s_pHeads[g_sActors.region[i]] = g_sActors.rnext[i];
+
+    if (g_sActors.rnext[i] >= 0)
+        g_sActors.rprev[g_sActors.rnext[i]] = g_sActors.rprev[i];
+}
+
+/**
+ * Fires the spawners near the view and gathers the actors close enough
+ * to it to stay awake. Everything else is left alone until the view
+ * comes back.
+ *
+ * Parameters:
+ * nLeft		Left edge of the view, in pixels
+ * nRight		Right edge of the view, in pixels
+ * pfnSpawn		Creates the actor of a spawner
+ */
+void regionUpdate(int nLeft, int nRight, SPAWNFUNC pfnSpawn) {
+    int r, r0, r1;
+    int i;
+    int * pNew;
+
+    // Spawn what the view is about to reach
+    r0 = regionAt(nLeft - REGION_SPAWN_MARGIN);
+    r1 = regionAt(nRight + REGION_SPAWN_MARGIN);
+    for (i = s_pSpawnFirst[r0]; i < s_pSpawnFirst[r1 + 1]; i++) {
+        if (s_pSpawners[i].done)
+            continue;
+
+        s_pSpawners[i].done = 1;
+        pfnSpawn(s_pSpawners[i].kind, s_pSpawners[i].x, s_pSpawners[i].y);
+    }
+
+    // Gather the awake set
+    g_nAwake = 0;
+    r0 = regionAt(nLeft - REGION_SLEEP_MARGIN);
+    r1 = regionAt(nRight + REGION_SLEEP_MARGIN);
+    for (r = r0; r <= r1; r++) {
+        for (i = s_pHeads[r]; i >= 0; i = g_sActors.rnext[i]) {
+            if (g_nAwake == s_nAwakeCap) {
+                pNew = realloc(g_pAwake, (s_nAwakeCap ? s_nAwakeCap * 2 : 256) * sizeof(int));
+                if (pNew == NULL)
+                    return;
+                g_pAwake = pNew;
+                s_nAwakeCap = s_nAwakeCap ? s_nAwakeCap * 2 : 256;
+            }
+
+            g_pAwake[g_nAwake++] = i;
+        }
+    }
+}
+
+/**
+ * Moves awake actors that crossed into another region to its list
+ */
+void regionRefresh(void) {
+    int n;
+    int i;
+
+    for (n = 0; n < g_nAwake; n++) {
+        i = g_pAwake[n];
+        if (!g_sActors.used[i] || regionAt(g_sActors.x[i]) == g_sActors.region[i])
+            continue;
+
+        regionRemove(i);
+        regionInsert(i);
+    }
+}
+
+/**
+ * Packs which spawners have fired and the awake list into a buffer.
+ * Returns the size of the packed data, writing nothing if the buffer is
+ * NULL. The region lists live in the actor pool.
+ *
+ * Parameters:
+ * p			Buffer to pack into, or NULL to measure
+ */
+size_t regionPack(unsigned char * p) {
+    size_t nSize = 2 * sizeof(int) + s_nSpawners + g_nAwake * sizeof(int);
+    int i;
+
+    if (p == NULL)
+        return nSize;
+
+    memcpy(p, & s_nSpawners, sizeof(int));
+    p += sizeof(int);
+    for (i = 0; i < s_nSpawners; i++)
+        * p++ = s_pSpawners[i].done;
+
+    memcpy(p, & g_nAwake, sizeof(int));
+    p += sizeof(int);
+    memcpy(p, g_pAwake, g_nAwake * sizeof(int));
+
+    return nSize;
+}
+
+/**
+ * Restores data packed by regionPack, once the actor pool it goes with is
+ * back, and finds the head of each region list again. Returns the number
+ * of bytes read, 0 if the data belongs to another map or memory ran out.
+ *
+ * Parameters:
+ * p			Packed data
+ */
+size_t regionUnpack(const unsigned char * p) {
+    const unsigned char * pStart = p;
+    int nCount;
+    int * pNew;
+    int i;
+
+    memcpy( & nCount, p, sizeof(int));
+    p += sizeof(int);
+    if (nCount != s_nSpawners)
+        return 0;
+
+    for (i = 0; i < s_nSpawners; i++)
+        s_pSpawners[i].done = * p++;
+
+    memcpy( & nCount, p, sizeof(int));
+    p += sizeof(int);
+    if (nCount > s_nAwakeCap) {
+        pNew = realloc(g_pAwake, nCount * sizeof(int));
+        if (pNew == NULL)
+            return 0;
+        g_pAwake = pNew;
+        s_nAwakeCap = nCount;
+    }
+
+    g_nAwake = nCount;
+    memcpy(g_pAwake, p, nCount * sizeof(int));
+    p += nCount * sizeof(int);
+
+    // Every listed actor without a predecessor heads its region
+    for (i = 0; i < s_nRegions; i++)
+        s_pHeads[i] = -1;
+    for (i = 0; i < g_sActors.count; i++)
+        if (g_sActors.used[i] && g_sActors.rprev[i] < 0)
+            s_pHeads[g_sActors.region[i]] = i;
+
+    return p - pStart;
+}
+
+/**
+ * Lists the variables holding the regions of a game, returns how many
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int regionState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, g_pAwake);
+    STATE_ADD(pVars, n, g_nAwake);
+    STATE_ADD(pVars, n, s_nAwakeCap);
+    STATE_ADD(pVars, n, s_pHeads);
+    STATE_ADD(pVars, n, s_nRegions);
+    STATE_ADD(pVars, n, s_pSpawners);
+    STATE_ADD(pVars, n, s_nSpawners);
+    STATE_ADD(pVars, n, s_pSpawnFirst);
+
+    return n;
+}
@@ -0,0 +1,58 @@
+/**
+ * File:        region.h
+ * Purpose:     Header file for region.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _REGION_H_
+#define _REGION_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "state.h"
+
+#include "actor.h"
+
+// Width of a region, a column of the map, as a power of two in pixels
+#define REGION_SHIFT 8
+
+// Spawners fire once the view comes this close, in pixels
+#define REGION_SPAWN_MARGIN 320
+
+// Actors further than this from the view sleep, in pixels
+#define REGION_SLEEP_MARGIN 640
+
+// Place where an actor of a kind enters the game
+typedef struct SPAWNER
+{
+	int x, y;
+	unsigned char kind;
+	unsigned char done;
+} SPAWNER;
+
+// Creates an actor for a spawner
+typedef ACTOR (* SPAWNFUNC)(int nKind, int x, int y);
+
+// Slots of the actors near the view, gathered by regionUpdate
+extern SIM_LOCAL int * g_pAwake;
+extern SIM_LOCAL int g_nAwake;
+
+// Function declarations
+int regionBuild(const SPAWNER * pDefault, int nDefault);
+void regionFree(void);
+void regionReset(void);
+void regionInsert(int i);
+void regionRemove(int i);
+void regionUpdate(int nLeft, int nRight, SPAWNFUNC pfnSpawn);
+void regionRefresh(void);
+size_t regionPack(unsigned char * p);
+size_t regionUnpack(const unsigned char * p);
+int regionState(STATEVAR * pVars);
+
+#endif
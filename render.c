@@ -0,0 +1,182 @@
+/**
+ * File:        render.c
+ * Purpose:     Hands frames from the simulation thread to the render
+ *              thread through a triple buffer, without either waiting
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "render.h"
+
+// Set on the waiting frame until the renderer takes it
+#define RENDER_FRESH 0x04
+#define RENDER_INDEX 0x03
+
+// The three frames
+static RENDERFRAME s_aFrames[RENDER_FRAMES];
+
+// Frame waiting between the two threads, with RENDER_FRESH, the only
+// thing both of them touch
+static int s_nShared = 1;
+
+// Frame being filled, only touched by the simulation thread
+static int s_nBack = 2;
+
+// Frame being drawn, only touched by the render thread
+static int s_nFront = 0;
+static int s_bTaken = 0;
+
+// Cells changed since the last frame known to be taken, and how many of
+// them the frame published before the newest one had
+static RENDERCELL * s_pPending = NULL;
+static int s_nPending = 0;
+static int s_nPendingCap = 0;
+static int s_nPublished = 0;
+
+/**
+ * Grows an array to hold at least nCount items
+ *
+ * Parameters:
+ * ppItems		Array to grow
+ * pCap			Capacity of the array
+ * nCount		Items wanted
+ * nSize		Size of an item
+ */
+static int renderGrow(void ** ppItems, int * pCap, int nCount, size_t nSize) {
+    void * pNew;
+    int nCap;
+
+    if (nCount <= * pCap)
+        return 0;
+
+    nCap = * pCap ? * pCap : 64;
+    while (nCap < nCount)
+        nCap *= 2;
+
+    pNew = realloc( * ppItems, nCap * nSize);
+    if (pNew == NULL)
+        return -1;
+
+    * ppItems = pNew;
+    * pCap = nCap;
+
+    return 0;
+}
+
+/**
+ * Frees the frames, once the render thread is done
+ */
+void renderFree(void) {
+    int i;
+
+    for (i = 0; i < RENDER_FRAMES; i++) {
+        free(s_aFrames[i].actors);
+        free(s_aFrames[i].cells);
+    }
+    memset(s_aFrames, 0, sizeof(s_aFrames));
+    free(s_pPending);
+
+    s_pPending = NULL;
+    s_nPending = 0;
+    s_nPendingCap = 0;
+    s_nPublished = 0;
+    s_nShared = 1;
+    s_nBack = 2;
+    s_nFront = 0;
+    s_bTaken = 0;
+}
+
+/**
+ * Returns the frame to fill next, for the simulation thread
+ */
+RENDERFRAME * renderBack(void) {
+    return & s_aFrames[s_nBack];
+}
+
+/**
+ * Adds an actor to a frame being filled, returns it or NULL if out of
+ * memory
+ *
+ * Parameters:
+ * pFrame		Frame being filled
+ */
+RENDERACTOR * renderAddActor(RENDERFRAME * pFrame) {
+    if (renderGrow((void ** ) & pFrame -> actors, & pFrame -> capactors, pFrame -> nactors + 1, sizeof(RENDERACTOR)) != 0)
+        return NULL;
+
+    return & pFrame -> actors[pFrame -> nactors++];
+}
+
+/**
+ * Notes a map cell that changed, for the next frame published and every
+ * one after it until the renderer is known to have seen it
+ *
+ * Parameters:
+ * nCell		Index of the cell
+ * nBlock		Block Mappy should show there
+ */
+int renderCell(int nCell, int nBlock) {
+    if (renderGrow((void ** ) & s_pPending, & s_nPendingCap, s_nPending + 1, sizeof(RENDERCELL)) != 0)
+        return -1;
+
+    s_pPending[s_nPending].cell = nCell;
+    s_pPending[s_nPending].block = nBlock;
+    s_nPending++;
+
+    return 0;
+}
+
+/**
+ * Publishes the frame filled, for the simulation thread. Never waits: a
+ * frame the renderer did not get to in time is taken back and filled
+ * again, and its cells go out with the next one.
+ */
+int renderPublish(void) {
+    RENDERFRAME * pFrame = & s_aFrames[s_nBack];
+    int nOld;
+
+    if (renderGrow((void ** ) & pFrame -> cells, & pFrame -> capcells, s_nPending, sizeof(RENDERCELL)) != 0)
+        return -1;
+    memcpy(pFrame -> cells, s_pPending, s_nPending * sizeof(RENDERCELL));
+    pFrame -> ncells = s_nPending;
+
+    // Filling the frame happens before the swap, as seen by the renderer
+    nOld = __atomic_exchange_n( & s_nShared, s_nBack | RENDER_FRESH, __ATOMIC_ACQ_REL);
+    s_nBack = nOld & RENDER_INDEX;
+
+    // The frame published before this one was taken, so were its cells
+    if (!(nOld & RENDER_FRESH)) {
+        s_nPending -= s_nPublished;
+        memmove(s_pPending, s_pPending + s_nPublished, s_nPending * sizeof(RENDERCELL));
+    }
+    s_nPublished = s_nPending;
+
+    return 0;
+}
+
+/**
+ * Returns the newest frame published, for the render thread, NULL if none
+ * has been yet. The frame stays put until the next call.
+ *
+ * Parameters:
+ * pNew			Receives whether the frame was not returned before
+ */
+const RENDERFRAME * renderTake(int * pNew) {
+    int nOld;
+
+    * pNew = 0;
+
+    if (__atomic_load_n( & s_nShared, __ATOMIC_ACQUIRE) & RENDER_FRESH) {
+        nOld = __atomic_exchange_n( & s_nShared, s_nFront, __ATOMIC_ACQ_REL);
+        s_nFront = nOld & RENDER_INDEX;
+        s_bTaken = 1;
+        * pNew = 1;
+    }
+
+    return s_bTaken ? & s_aFrames[s_nFront] : NULL;
+}
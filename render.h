@@ -0,0 +1,80 @@
+/**
+ * File:        render.h
+ * Purpose:     Header file for render.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _RENDER_H_
+#define _RENDER_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Frames handed over, the renderer holds one, the simulation fills one
+// and the newest finished one waits in between
+#define RENDER_FRAMES 3
+
+// One actor as it is to be drawn
+typedef struct RENDERACTOR
+{
+	int x, y;
+	int oldx, oldy;
+	int w, h;
+	int kind;
+	int frame;
+	int dir;
+} RENDERACTOR;
+
+// A map cell that changed, with the block Mappy should show there
+typedef struct RENDERCELL
+{
+	int cell;
+	int block;
+} RENDERCELL;
+
+// Everything needed to draw the game after a tick. Filled by the
+// simulation thread, then never changed while the renderer has it.
+typedef struct RENDERFRAME
+{
+	int mode;
+	long tick;
+
+	// pace.c clock when published, and progress towards the next tick then
+	double clock;
+	int accum;
+
+	// Player and what the HUD shows
+	RENDERACTOR player;
+	int alive;
+	int victory;
+	int score;
+	int highscore;
+	int timeleft;
+	int gemvalue;
+	int gemticks;
+
+	// Other living actors near the view
+	RENDERACTOR * actors;
+	int nactors;
+	int capactors;
+
+	// Cells changed since the last frame the renderer took
+	RENDERCELL * cells;
+	int ncells;
+	int capcells;
+} RENDERFRAME;
+
+// Function declarations
+void renderFree(void);
+RENDERFRAME * renderBack(void);
+RENDERACTOR * renderAddActor(RENDERFRAME * pFrame);
+int renderCell(int nCell, int nBlock);
+int renderPublish(void);
+const RENDERFRAME * renderTake(int * pNew);
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * File:        replay.c
+ * Purpose:     Recording and playback of per-tick input
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "replay.h"
+#include "sim.h"
+
+// Longest run of one input stored in a single record
+#define REPLAY_MAX_RUN 0xffff
+
+/**
+ * Writes a little-endian value of nBytes bytes
+ *
+ * Parameters:
+ * fp			File to write to
+ * nValue		Value to write
+ * nBytes		Size of the value
+ */
+static void putValue(FILE * fp, unsigned long nValue, int nBytes) {
+    while (nBytes-- > 0) {
+        fputc((int)(nValue & 0xff), fp);
+        nValue >>= 8;
+    }
+}
+
+/**
+ * Reads a little-endian value of nBytes bytes, returns -1 at end of file
+ *
+ * Parameters:
+ * fp			File to read from
+ * nBytes		Size of the value
+ * pValue		Receives the value
+ */
+static int getValue(FILE * fp, int nBytes, unsigned long * pValue) {
+    int i;
+    int c;
+
+    * pValue = 0;
+    for (i = 0; i < nBytes; i++) {
+        c = fgetc(fp);
+        if (c == EOF)
+            return -1;
+        * pValue |= (unsigned long) c << (i * 8);
+    }
+
+    return 0;
+}
+
+/**
+ * Creates an empty replay
+ */
+REPLAY * replayCreate(void) {
+    return calloc(1, sizeof(REPLAY));
+}
+
+/**
+ * Frees a replay
+ *
+ * Parameters:
+ * pReplay		Replay to free
+ */
+void replayFree(REPLAY * pReplay) {
+    if (pReplay == NULL)
+        return;
+
+    free(pReplay -> inputs);
+    free(pReplay -> checksums);
+    free(pReplay);
+}
+
+/**
+ * Appends one tick to a replay
+ *
+ * Parameters:
+ * pReplay		Replay to add to
+ * nInput		INPUT_* buttons given to the tick
+ * nChecksum	State checksum after the tick
+ */
+int replayRecord(REPLAY * pReplay, int nInput, unsigned int nChecksum) {
+    unsigned char * pInputs;
+    unsigned short * pChecksums;
+    long nCap;
+
+    if (pReplay -> nticks == pReplay -> cap) {
+        nCap = pReplay -> cap ? pReplay -> cap * 2 : 4096;
+
+        pInputs = realloc(pReplay -> inputs, nCap);
+        if (pInputs == NULL)
+            return -1;
+        pReplay -> inputs = pInputs;
+
+        pChecksums = realloc(pReplay -> checksums, nCap * sizeof(unsigned short));
+        if (pChecksums == NULL)
+            return -1;
+        pReplay -> checksums = pChecksums;
+
+        pReplay -> cap = nCap;
+    }
+
+    pReplay -> inputs[pReplay -> nticks] = nInput;
+    pReplay -> checksums[pReplay -> nticks] = REPLAY_FOLD(nChecksum);
+    pReplay -> nticks++;
+
+    return 0;
+}
+
+/**
+ * Saves a replay: a header, the input as runs of equal ticks, then the
+ * folded checksum of every tick
+ *
+ * Parameters:
+ * pReplay		Replay to save
+ * szPath		Path to the replay file
+ */
+int replaySave(const REPLAY * pReplay, const char * szPath) {
+    FILE * fp;
+    long i, j;
+    long nRuns = 0;
+
+    fp = fopen(szPath, "wb");
+    if (fp == NULL)
+        return -1;
+
+    // Count the runs first, the header needs them
+    for (i = 0; i < pReplay -> nticks; i = j, nRuns++)
+        for (j = i + 1; j < pReplay -> nticks && j - i < REPLAY_MAX_RUN && pReplay -> inputs[j] == pReplay -> inputs[i]; j++);
+
+    fwrite("GDRP", 1, 4, fp);
+    putValue(fp, REPLAY_VERSION, 2);
+    putValue(fp, pReplay -> nticks, 4);
+    putValue(fp, nRuns, 4);
+
+    for (i = 0; i < pReplay -> nticks; i = j) {
+        for (j = i + 1; j < pReplay -> nticks && j - i < REPLAY_MAX_RUN && pReplay -> inputs[j] == pReplay -> inputs[i]; j++);
+
+        putValue(fp, pReplay -> inputs[i], 1);
+        putValue(fp, j - i, 2);
+    }
+
+    for (i = 0; i < pReplay -> nticks; i++)
+        putValue(fp, pReplay -> checksums[i], 2);
+
+    if (fclose(fp) != 0)
+        return -1;
+
+    return 0;
+}
+
+/**
+ * Loads a replay, returns NULL if the file is missing, damaged or was made
+ * by another version
+ *
+ * Parameters:
+ * szPath		Path to the replay file
+ */
+REPLAY * replayLoad(const char * szPath) {
+    FILE * fp;
+    REPLAY * pReplay;
+    char aMagic[4];
+    unsigned long nVersion, nTicks, nRuns;
+    unsigned long nInput, nLength, nChecksum;
+    unsigned long i;
+    long nTick = 0;
+
+    fp = fopen(szPath, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    pReplay = replayCreate();
+    if (pReplay == NULL || fread(aMagic, 1, 4, fp) != 4 || memcmp(aMagic, "GDRP", 4) ||
+        getValue(fp, 2, & nVersion) || nVersion != REPLAY_VERSION ||
+        getValue(fp, 4, & nTicks) || getValue(fp, 4, & nRuns))
+        goto fail;
+
+    pReplay -> inputs = malloc(nTicks ? nTicks : 1);
+    pReplay -> checksums = malloc((nTicks ? nTicks : 1) * sizeof(unsigned short));
+    if (pReplay -> inputs == NULL || pReplay -> checksums == NULL)
+        goto fail;
+
+    pReplay -> cap = nTicks;
+
+    for (i = 0; i < nRuns; i++) {
+        if (getValue(fp, 1, & nInput) || getValue(fp, 2, & nLength) || nTick + (long) nLength > (long) nTicks)
+            goto fail;
+
+        memset(pReplay -> inputs + nTick, (int) nInput, nLength);
+        nTick += nLength;
+    }
+
+    if (nTick != (long) nTicks)
+        goto fail;
+
+    for (i = 0; i < nTicks; i++) {
+        if (getValue(fp, 2, & nChecksum))
+            goto fail;
+        pReplay -> checksums[i] = nChecksum;
+    }
+
+    pReplay -> nticks = nTicks;
+    fclose(fp);
+
+    return pReplay;
+
+fail:
+    fclose(fp);
+    replayFree(pReplay);
+    return NULL;
+}
+
+/**
+ * Checks the state after a tick against the recording
+ *
+ * Parameters:
+ * pReplay		Replay to check against
+ * nTick		Tick just simulated, counted from 0
+ * nChecksum	State checksum after the tick
+ */
+int replayCheck(const REPLAY * pReplay, long nTick, unsigned int nChecksum) {
+    return nTick < pReplay -> nticks && pReplay -> checksums[nTick] == REPLAY_FOLD(nChecksum);
+}
+
+/**
+ * Plays a replay as fast as possible from a freshly started simulation,
+ * returns the first tick that differs from the recording or -1 if all of
+ * them matched
+ *
+ * Parameters:
+ * pReplay		Replay to play
+ */
+long replayRun(const REPLAY * pReplay) {
+    long nTick;
+
+    for (nTick = 0; nTick < pReplay -> nticks; nTick++) {
+        simTick(pReplay -> inputs[nTick]);
+
+        // Nobody draws the changed cells
+        g_pLevel -> ndirty = 0;
+        g_pLevel -> alldirty = 0;
+
+        if (!replayCheck(pReplay, nTick, simChecksum()))
+            return nTick;
+    }
+
+    return -1;
+}
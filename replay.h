@@ -0,0 +1,44 @@
+/**
+ * File:        replay.h
+ * Purpose:     Header file for replay.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+// Include C stdlib
+#include <stdio.h>
+#include <stdlib.h>
+
+// Replay file format version, bump when the simulation changes behaviour
+#define REPLAY_VERSION 7
+
+// Folds a state checksum to the 16 bits kept per tick
+#define REPLAY_FOLD(sum) ((unsigned short)(((sum) ^ ((sum) >> 16)) & 0xffff))
+
+// Input of every tick since the simulation started, with the folded state
+// checksum after each one
+typedef struct REPLAY
+{
+	long nticks;
+	long cap;
+	unsigned char * inputs;
+	unsigned short * checksums;
+} REPLAY;
+
+// Function declarations
+REPLAY * replayCreate(void);
+void replayFree(REPLAY * pReplay);
+int replayRecord(REPLAY * pReplay, int nInput, unsigned int nChecksum);
+int replaySave(const REPLAY * pReplay, const char * szPath);
+REPLAY * replayLoad(const char * szPath);
+int replayCheck(const REPLAY * pReplay, long nTick, unsigned int nChecksum);
+long replayRun(const REPLAY * pReplay);
+
+#endif
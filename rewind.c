@@ -0,0 +1,500 @@
+/**
+ * File:        rewind.c
+ * Purpose:     Keeps the recent ticks of the game being played, to go back
+ *              to any of them
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "rewind.h"
+#include "snapshot.h"
+#include "sim.h"
+
+// Unchanged bytes it takes to end a run of changed ones, fewer cost more to
+// skip than to store
+#define REWIND_GAP 4
+
+// Bytes compared at a time while skipping unchanged parts of a snapshot
+#define REWIND_CHUNK 16
+
+// Frame record n, counting from the oldest
+#define REWIND_FRAME(pRewind, n) (& (pRewind) -> frames[((pRewind) -> first + (n)) % (pRewind) -> maxframes])
+
+// Byte k of a snapshot XORed with the one before, which may be shorter
+#define REWIND_XOR(pCur, pPrev, nPrev, k) ((pCur)[k] ^ ((k) < (nPrev) ? (pPrev)[k] : 0))
+
+/**
+ * Writes a count seven bits at a time, returns the end of it
+ *
+ * Parameters:
+ * p			Where to write
+ * nCount		Count to write
+ */
+static unsigned char * putCount(unsigned char * p, size_t nCount) {
+    while (nCount >= 0x80) {
+        * p++ = (unsigned char)((nCount & 0x7f) | 0x80);
+        nCount >>= 7;
+    }
+    * p++ = (unsigned char) nCount;
+
+    return p;
+}
+
+/**
+ * Reads a count written by putCount, returns the end of it
+ *
+ * Parameters:
+ * p			Where to read
+ * pCount		Receives the count
+ */
+static const unsigned char * getCount(const unsigned char * p, size_t * pCount) {
+    size_t nCount = 0;
+    int nShift = 0;
+
+    while ( * p & 0x80) {
+        nCount |= (size_t)( * p++ & 0x7f) << nShift;
+        nShift += 7;
+    }
+    * pCount = nCount | (size_t) * p++ << nShift;
+
+    return p;
+}
+
+/**
+ * Encodes a snapshot into the scratch space as runs of unchanged bytes,
+ * which are skipped, and runs of changed ones, stored XORed with the
+ * snapshot before. Returns the encoded size.
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * pCur			Snapshot to encode
+ * nSize		Size of the snapshot
+ * pPrev		Snapshot before it, NULL for a keyframe
+ * nPrev		Size of the snapshot before it
+ */
+static size_t rewindEncode(REWIND * pRewind, const unsigned char * pCur, size_t nSize,
+    const unsigned char * pPrev, size_t nPrev) {
+    unsigned char * pOut = pRewind -> work;
+    size_t nSame = nPrev < nSize ? nPrev : nSize; // Bytes both snapshots have
+    size_t i = 0;
+    size_t nStart, nEnd, nZeros;
+
+    while (i < nSize) {
+        // Skip what did not change, a chunk at a time where possible
+        nStart = i;
+        while (i + REWIND_CHUNK <= nSame && !memcmp(pCur + i, pPrev + i, REWIND_CHUNK))
+            i += REWIND_CHUNK;
+        while (i < nSize && REWIND_XOR(pCur, pPrev, nPrev, i) == 0)
+            i++;
+        if (i == nSize)
+            break;
+
+        // Changed bytes run on until enough unchanged ones follow
+        nZeros = 0;
+        for (nEnd = i; nEnd < nSize && nZeros < REWIND_GAP; nEnd++)
+            nZeros = REWIND_XOR(pCur, pPrev, nPrev, nEnd) ? 0 : nZeros + 1;
+        nEnd -= nZeros;
+
+        pOut = putCount(pOut, i - nStart);
+        pOut = putCount(pOut, nEnd - i);
+        for (; i < nEnd; i++)
+            * pOut++ = REWIND_XOR(pCur, pPrev, nPrev, i);
+    }
+
+    return pOut - pRewind -> work;
+}
+
+/**
+ * Turns the snapshot of the tick before a frame into the snapshot of the
+ * frame, in place
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * pFrame		Frame to apply
+ * pBuf			Snapshot before the frame, empty for a keyframe
+ * nPrev		Size of the snapshot before the frame
+ */
+static void rewindApply(const REWIND * pRewind, const REWINDFRAME * pFrame, unsigned char * pBuf, size_t nPrev) {
+    const unsigned char * p = pRewind -> ring + pFrame -> offset;
+    const unsigned char * pEnd = p + pFrame -> encoded;
+    size_t i = 0;
+    size_t nZeros, nChanged;
+
+    // Bytes the snapshot before did not have were XORed with nothing
+    if (pFrame -> size > nPrev)
+        memset(pBuf + nPrev, 0, pFrame -> size - nPrev);
+
+    while (p < pEnd) {
+        p = getCount(p, & nZeros);
+        p = getCount(p, & nChanged);
+
+        i += nZeros;
+        while (nChanged-- > 0)
+            pBuf[i++] ^= * p++;
+    }
+}
+
+/**
+ * Rebuilds the snapshot of a tick held in the ring from its keyframe and
+ * the deltas after it. Returns the size of the snapshot, 0 if the tick is
+ * not held.
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * nTick		Tick to rebuild
+ * pBuf			Receives the snapshot
+ */
+static size_t rewindDecode(const REWIND * pRewind, long nTick, unsigned char * pBuf) {
+    const REWINDFRAME * pFrame;
+    size_t nSize = 0;
+    int n, k;
+
+    if (pRewind -> count == 0 || nTick < rewindOldest(pRewind) || nTick > rewindNewest(pRewind))
+        return 0;
+
+    // Ticks held follow each other, and the oldest is always a keyframe
+    n = (int)(nTick - rewindOldest(pRewind));
+    for (k = n; !REWIND_FRAME(pRewind, k) -> key; k--);
+
+    for (; k <= n; k++) {
+        pFrame = REWIND_FRAME(pRewind, k);
+        rewindApply(pRewind, pFrame, pBuf, pFrame -> key ? 0 : nSize);
+        nSize = pFrame -> size;
+    }
+
+    return nSize;
+}
+
+/**
+ * Forgets the oldest keyframe and the deltas that depend on it
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+static void rewindEvict(REWIND * pRewind) {
+    do {
+        pRewind -> first = (pRewind -> first + 1) % pRewind -> maxframes;
+        pRewind -> count--;
+        pRewind -> oldest++;
+    } while (pRewind -> count > 0 && !REWIND_FRAME(pRewind, 0) -> key);
+}
+
+/**
+ * Finds room for a frame in the ring, forgetting the oldest ticks until it
+ * fits. Returns -1 if the frame is larger than the whole ring.
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * nBytes		Size of the frame
+ * pOffset		Receives where the frame goes
+ */
+static int rewindPlace(REWIND * pRewind, size_t nBytes, size_t * pOffset) {
+    size_t nTail;
+
+    if (nBytes > pRewind -> budget)
+        return -1;
+
+    for (;;) {
+        if (pRewind -> count == 0) {
+            pRewind -> head = 0;
+            * pOffset = 0;
+            return 0;
+        }
+
+        if (pRewind -> count < pRewind -> maxframes) {
+            nTail = REWIND_FRAME(pRewind, 0) -> offset;
+            if (nTail < pRewind -> head) {
+                // Frames fill the middle, room at the end or else the start
+                if (pRewind -> head + nBytes <= pRewind -> budget) {
+                    * pOffset = pRewind -> head;
+                    return 0;
+                }
+                if (nBytes <= nTail) {
+                    * pOffset = 0;
+                    return 0;
+                }
+            } else if (pRewind -> head + nBytes <= nTail) {
+                // Frames wrapped around, room between the newest and oldest
+                * pOffset = pRewind -> head;
+                return 0;
+            }
+        }
+
+        rewindEvict(pRewind);
+    }
+}
+
+/**
+ * Makes sure the snapshot buffers hold nSize bytes
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * nSize		Size of a snapshot
+ */
+static int rewindReserve(REWIND * pRewind, size_t nSize) {
+    unsigned char * pNew;
+    size_t nCap;
+
+    if (nSize <= pRewind -> cap)
+        return 0;
+
+    nCap = nSize + nSize / 4;
+
+    pNew = realloc(pRewind -> last, nCap);
+    if (pNew == NULL)
+        return -1;
+    pRewind -> last = pNew;
+
+    pNew = realloc(pRewind -> snap, nCap);
+    if (pNew == NULL)
+        return -1;
+    pRewind -> snap = pNew;
+
+    // Room for the worst case, a changed byte between every few unchanged
+    pNew = realloc(pRewind -> work, nCap * 3 + 16);
+    if (pNew == NULL)
+        return -1;
+    pRewind -> work = pNew;
+
+    pRewind -> cap = nCap;
+
+    return 0;
+}
+
+/**
+ * Creates an empty rewind buffer
+ *
+ * Parameters:
+ * nBudget		Bytes to keep ticks in
+ * nKeyEvery	Ticks from one keyframe to the next, 0 for the default
+ */
+REWIND * rewindCreate(size_t nBudget, int nKeyEvery) {
+    REWIND * pRewind;
+
+    if (nKeyEvery < 1)
+        nKeyEvery = REWIND_KEY_EVERY;
+
+    pRewind = calloc(1, sizeof(REWIND));
+    if (pRewind == NULL)
+        return NULL;
+
+    pRewind -> budget = nBudget;
+    pRewind -> keyevery = nKeyEvery;
+    pRewind -> maxframes = nBudget / REWIND_FRAME_BYTES;
+    if (pRewind -> maxframes <= nKeyEvery)
+        pRewind -> maxframes = nKeyEvery + 1;
+    pRewind -> lasttick = -1;
+
+    pRewind -> ring = malloc(nBudget);
+    pRewind -> frames = malloc(pRewind -> maxframes * sizeof(REWINDFRAME));
+    if (pRewind -> ring == NULL || pRewind -> frames == NULL) {
+        rewindFree(pRewind);
+        return NULL;
+    }
+
+    return pRewind;
+}
+
+/**
+ * Frees a rewind buffer
+ *
+ * Parameters:
+ * pRewind		Rewind buffer to free
+ */
+void rewindFree(REWIND * pRewind) {
+    if (pRewind == NULL)
+        return;
+
+    free(pRewind -> ring);
+    free(pRewind -> frames);
+    free(pRewind -> last);
+    free(pRewind -> snap);
+    free(pRewind -> work);
+    free(pRewind);
+}
+
+/**
+ * Forgets every tick held
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+void rewindClear(REWIND * pRewind) {
+    pRewind -> first = 0;
+    pRewind -> count = 0;
+    pRewind -> head = 0;
+    pRewind -> sincekey = 0;
+}
+
+/**
+ * Keeps the state of the game as tick nTick. Carrying on from an earlier
+ * tick forgets the ticks that came after it, and a tick that does not
+ * follow the newest one starts over. When the ring is full the oldest
+ * keyframe goes, along with its deltas. Returns 0 on success, -1 if the
+ * tick could not be kept.
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * nTick		Tick the game is at
+ */
+int rewindPush(REWIND * pRewind, long nTick) {
+    REWINDFRAME * pFrame;
+    unsigned char * pSwap;
+    size_t nSize, nBytes, nOffset;
+    int bKey;
+    int n;
+
+    nSize = snapSave(NULL, 0, SNAP_DELTA);
+    if (rewindReserve(pRewind, nSize) != 0)
+        return -1;
+    snapSave(pRewind -> snap, nSize, SNAP_DELTA);
+
+    // Carrying on from an earlier tick
+    if (pRewind -> count > 0 && rewindNewest(pRewind) >= nTick) {
+        while (pRewind -> count > 0 && rewindNewest(pRewind) >= nTick) {
+            pFrame = REWIND_FRAME(pRewind, pRewind -> count - 1);
+            pRewind -> head = pFrame -> offset;
+            pRewind -> count--;
+        }
+
+        pRewind -> sincekey = 0;
+        for (n = pRewind -> count - 1; n >= 0 && !REWIND_FRAME(pRewind, n) -> key; n--)
+            pRewind -> sincekey++;
+    }
+
+    // Deltas are against the tick before, which has to be held
+    if (pRewind -> count > 0 && rewindNewest(pRewind) != nTick - 1)
+        rewindClear(pRewind);
+    if (pRewind -> count > 0 && pRewind -> lasttick != nTick - 1) {
+        pRewind -> lastsize = rewindDecode(pRewind, nTick - 1, pRewind -> last);
+        pRewind -> lasttick = nTick - 1;
+    }
+
+    bKey = pRewind -> count == 0 || pRewind -> sincekey >= pRewind -> keyevery - 1;
+    if (bKey)
+        nBytes = rewindEncode(pRewind, pRewind -> snap, nSize, NULL, 0);
+    else
+        nBytes = rewindEncode(pRewind, pRewind -> snap, nSize, pRewind -> last, pRewind -> lastsize);
+
+    if (rewindPlace(pRewind, nBytes, & nOffset) != 0) {
+        rewindClear(pRewind);
+        return -1;
+    }
+
+    // Making room took the tick before as well, start with a keyframe
+    if (!bKey && pRewind -> count == 0) {
+        bKey = 1;
+        nBytes = rewindEncode(pRewind, pRewind -> snap, nSize, NULL, 0);
+        if (rewindPlace(pRewind, nBytes, & nOffset) != 0)
+            return -1;
+    }
+
+    memcpy(pRewind -> ring + nOffset, pRewind -> work, nBytes);
+    pRewind -> head = nOffset + nBytes;
+
+    if (pRewind -> count == 0)
+        pRewind -> oldest = nTick;
+
+    pFrame = REWIND_FRAME(pRewind, pRewind -> count);
+    pFrame -> offset = nOffset;
+    pFrame -> encoded = nBytes;
+    pFrame -> size = nSize;
+    pFrame -> key = bKey;
+    pRewind -> count++;
+
+    if (bKey) {
+        pRewind -> sincekey = 0;
+        pRewind -> keys++;
+        pRewind -> keybytes += nBytes;
+    } else {
+        pRewind -> sincekey++;
+        pRewind -> deltas++;
+        pRewind -> deltabytes += nBytes;
+    }
+
+    // This tick is what the next one is taken against
+    pSwap = pRewind -> last;
+    pRewind -> last = pRewind -> snap;
+    pRewind -> snap = pSwap;
+    pRewind -> lastsize = nSize;
+    pRewind -> lasttick = nTick;
+
+    return 0;
+}
+
+/**
+ * Puts the game back as it was at a tick held, rebuilt from the keyframe
+ * before it and at most keyevery - 1 deltas. The ticks after it are kept
+ * until play carries on from there. Returns 0 on success, -1 if the tick
+ * is not held.
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ * nTick		Tick to go to
+ */
+int rewindSeek(REWIND * pRewind, long nTick) {
+    size_t nSize;
+
+    if (nTick != pRewind -> lasttick || pRewind -> count == 0) {
+        nSize = rewindDecode(pRewind, nTick, pRewind -> last);
+        if (nSize == 0)
+            return -1;
+
+        pRewind -> lastsize = nSize;
+        pRewind -> lasttick = nTick;
+    }
+
+    return snapLoad(pRewind -> last, pRewind -> lastsize);
+}
+
+/**
+ * Returns the oldest tick held, -1 if none are
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+long rewindOldest(const REWIND * pRewind) {
+    return pRewind -> count > 0 ? pRewind -> oldest : -1;
+}
+
+/**
+ * Returns the newest tick held, -1 if none are
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+long rewindNewest(const REWIND * pRewind) {
+    return pRewind -> count > 0 ? pRewind -> oldest + pRewind -> count - 1 : -1;
+}
+
+/**
+ * Returns the bytes of the ring taken by the ticks held
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+size_t rewindUsed(const REWIND * pRewind) {
+    size_t nUsed = 0;
+    int n;
+
+    for (n = 0; n < pRewind -> count; n++)
+        nUsed += REWIND_FRAME(pRewind, n) -> encoded;
+
+    return nUsed;
+}
+
+/**
+ * Returns all the memory a rewind buffer takes, ring, records and scratch
+ *
+ * Parameters:
+ * pRewind		Rewind buffer
+ */
+size_t rewindMemory(const REWIND * pRewind) {
+    return sizeof(REWIND) + pRewind -> budget + pRewind -> maxframes * sizeof(REWINDFRAME) +
+        pRewind -> cap * 5 + 16;
+}
@@ -0,0 +1,76 @@
+/**
+ * File:        rewind.h
+ * Purpose:     Header file for rewind.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _REWIND_H_
+#define _REWIND_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Ticks from one keyframe to the next when none are given
+#define REWIND_KEY_EVERY 32
+
+// Ring bytes set aside per frame record, sizes the record table
+#define REWIND_FRAME_BYTES 32
+
+// One tick kept in the ring, encoded as the XOR of its snapshot with the
+// tick before, or with nothing for a keyframe, with zero runs left out
+typedef struct REWINDFRAME
+{
+	unsigned int offset;
+	unsigned int encoded;
+	unsigned int size;
+	int key;
+} REWINDFRAME;
+
+// Ticks of one game, oldest first, in a fixed amount of memory
+typedef struct REWIND
+{
+	// Ring of encoded frames
+	unsigned char * ring;
+	size_t budget;
+	size_t head;
+	int keyevery;
+
+	// Records of the frames held, in a ring of their own, for the ticks
+	// from oldest on
+	REWINDFRAME * frames;
+	int maxframes;
+	int first;
+	int count;
+	long oldest;
+	int sincekey;
+
+	// Snapshot of the tick deltas are taken against, and scratch space
+	unsigned char * last;
+	unsigned char * snap;
+	unsigned char * work;
+	size_t lastsize;
+	long lasttick;
+	size_t cap;
+
+	// Totals since creation, for measuring
+	long keys, deltas;
+	double keybytes, deltabytes;
+} REWIND;
+
+// Function declarations
+REWIND * rewindCreate(size_t nBudget, int nKeyEvery);
+void rewindFree(REWIND * pRewind);
+void rewindClear(REWIND * pRewind);
+int rewindPush(REWIND * pRewind, long nTick);
+int rewindSeek(REWIND * pRewind, long nTick);
+long rewindOldest(const REWIND * pRewind);
+long rewindNewest(const REWIND * pRewind);
+size_t rewindUsed(const REWIND * pRewind);
+size_t rewindMemory(const REWIND * pRewind);
+
+#endif
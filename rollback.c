@@ -0,0 +1,454 @@
+/**
+ * File:        rollback.c
+ * Purpose:     Rollback netcode: plays a two-player game on without waiting
+ *              for the peer's input, and plays ticks again when a guess
+ *              at it was wrong
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "rollback.h"
+#include "sim.h"
+#include "snapshot.h"
+#include "pace.h"
+
+// Tag at the start of every packet
+static const char s_szMagic[4] = { 'G', 'D', 'N', 'P' };
+
+/**
+ * Writes a 32-bit value to a packet, lowest byte first
+ *
+ * Parameters:
+ * p			Where to write
+ * nValue		Value to write
+ */
+static unsigned char * putLong(unsigned char * p, long nValue) {
+    unsigned long n = (unsigned long) nValue;
+
+    p[0] = (unsigned char)(n & 0xFF);
+    p[1] = (unsigned char)((n >> 8) & 0xFF);
+    p[2] = (unsigned char)((n >> 16) & 0xFF);
+    p[3] = (unsigned char)((n >> 24) & 0xFF);
+
+    return p + 4;
+}
+
+/**
+ * Reads a 32-bit value written by putLong
+ *
+ * Parameters:
+ * p			Where to read
+ * pValue		Receives the value
+ */
+static const unsigned char * getLong(const unsigned char * p, long * pValue) {
+    unsigned long n = (unsigned long) p[0] | ((unsigned long) p[1] << 8) | ((unsigned long) p[2] << 16) | ((unsigned long) p[3] << 24);
+
+    // Sign extend where long is wider than 32 bits
+    * pValue = (n & 0x80000000UL) ? -(long)(0xFFFFFFFFUL - n) - 1 : (long) n;
+
+    return p + 4;
+}
+
+/**
+ * Creates the state of a two-player game played against a peer. The game
+ * itself is whatever the simulation holds, started with two players.
+ * Returns NULL when out of memory.
+ *
+ * Parameters:
+ * nLocal		Slot of the player on this side, PLAYER or RIVAL
+ * nDelay		Ticks a local input waits before it is played, which gives
+ *				it time to reach the peer and saves rollbacks
+ */
+ROLLBACK * rollbackCreate(int nLocal, int nDelay) {
+    ROLLBACK * pRollback;
+    int i;
+
+    pRollback = calloc(1, sizeof(ROLLBACK));
+    if (pRollback == NULL)
+        return NULL;
+
+    if (nDelay < 0)
+        nDelay = 0;
+    if (nDelay > ROLLBACK_DELAY_MAX)
+        nDelay = ROLLBACK_DELAY_MAX;
+
+    pRollback -> local = nLocal == RIVAL ? RIVAL : PLAYER;
+    pRollback -> delay = nDelay;
+
+    // Nothing is pressed during the delay at the start
+    pRollback -> localknown = nDelay;
+
+    pRollback -> rollbackto = -1;
+    pRollback -> remotesumtick = -1;
+    pRollback -> checked = -1;
+    pRollback -> firstdesync = -1;
+
+    for (i = 0; i < ROLLBACK_SNAPS; i++)
+        pRollback -> snaps[i].tick = -1;
+
+    return pRollback;
+}
+
+/**
+ * Frees the state of a game played against a peer
+ *
+ * Parameters:
+ * pRollback	State to free, may be NULL
+ */
+void rollbackFree(ROLLBACK * pRollback) {
+    int i;
+
+    if (pRollback == NULL)
+        return;
+
+    for (i = 0; i < ROLLBACK_SNAPS; i++)
+        free(pRollback -> snaps[i].data);
+
+    free(pRollback);
+}
+
+/**
+ * Saves the state ahead of a tick. Returns -1 when out of memory.
+ *
+ * Parameters:
+ * pRollback	Game
+ * nTick		Tick about to be played
+ */
+static int rollbackSave(ROLLBACK * pRollback, long nTick) {
+    ROLLBACKSNAP * pSnap = & pRollback -> snaps[nTick % ROLLBACK_SNAPS];
+    double dStart = paceNow();
+    size_t nSize;
+    void * pData;
+
+    nSize = snapSave(NULL, 0, SNAP_DELTA);
+    if (nSize > pSnap -> cap) {
+        pData = realloc(pSnap -> data, nSize);
+        if (pData == NULL)
+            return -1;
+        pSnap -> data = pData;
+        pSnap -> cap = nSize;
+    }
+
+    pSnap -> size = snapSave(pSnap -> data, pSnap -> cap, SNAP_DELTA);
+    pSnap -> tick = nTick;
+
+    pRollback -> saves++;
+    pRollback -> savetime += paceNow() - dStart;
+
+    return 0;
+}
+
+/**
+ * Puts back the state ahead of a tick. Returns -1 if it is no longer held.
+ *
+ * Parameters:
+ * pRollback	Game
+ * nTick		Tick to go back to
+ */
+static int rollbackLoad(ROLLBACK * pRollback, long nTick) {
+    ROLLBACKSNAP * pSnap = & pRollback -> snaps[nTick % ROLLBACK_SNAPS];
+    double dStart = paceNow();
+
+    if (pSnap -> tick != nTick || snapLoad(pSnap -> data, pSnap -> size) != 0)
+        return -1;
+
+    pRollback -> loads++;
+    pRollback -> loadtime += paceNow() - dStart;
+
+    return 0;
+}
+
+/**
+ * Plays one tick with the inputs known for it, guessing that the peer
+ * still holds whatever it held last when its input is not known yet
+ *
+ * Parameters:
+ * pRollback	Game
+ * nTick		Tick to play, the one the simulation is at
+ */
+static void rollbackStep(ROLLBACK * pRollback, long nTick) {
+    int nRemote = 1 - pRollback -> local;
+    int nSlot = (int)(nTick & (ROLLBACK_HISTORY - 1));
+    int aInputs[2];
+
+    aInputs[pRollback -> local] = pRollback -> inputs[pRollback -> local][nSlot];
+
+    if (nTick < pRollback -> remoteknown)
+        aInputs[nRemote] = pRollback -> inputs[nRemote][nSlot];
+    else if (pRollback -> remoteknown > 0)
+        aInputs[nRemote] = pRollback -> inputs[nRemote][(pRollback -> remoteknown - 1) & (ROLLBACK_HISTORY - 1)];
+    else
+        aInputs[nRemote] = 0;
+
+    pRollback -> used[nSlot] = (unsigned char) aInputs[nRemote];
+
+    simTick(aInputs[PLAYER] | (aInputs[RIVAL] << INPUT_BITS));
+
+    pRollback -> sums[nSlot] = simChecksum();
+}
+
+/**
+ * Goes back to the earliest tick played with a wrong guess at the peer's
+ * input, if any, and plays the ticks since again, then checks the state
+ * against the peer's. Returns 1 if ticks were played again, 0 if there was
+ * nothing to correct and -1 if the state to go back to was lost.
+ *
+ * Parameters:
+ * pRollback	Game
+ */
+int rollbackCorrect(ROLLBACK * pRollback) {
+    long nFrom = pRollback -> rollbackto;
+    long nConfirmed;
+    double dStart;
+    long t;
+    int nResult = 0;
+
+    if (nFrom >= 0) {
+        dStart = paceNow();
+
+        if (rollbackLoad(pRollback, nFrom) != 0)
+            return -1;
+
+        for (t = nFrom; t < pRollback -> frame; t++) {
+            if (t > nFrom)
+                rollbackSave(pRollback, t);
+            rollbackStep(pRollback, t);
+        }
+
+        pRollback -> rollbacks++;
+        pRollback -> resimulated += pRollback -> frame - nFrom;
+        if (pRollback -> frame - nFrom > pRollback -> deepest)
+            pRollback -> deepest = pRollback -> frame - nFrom;
+        pRollback -> resimtime += paceNow() - dStart;
+
+        pRollback -> rollbackto = -1;
+        nResult = 1;
+    }
+
+    // Both sides played the same inputs up to here, so they must agree
+    nConfirmed = rollbackConfirmed(pRollback);
+    if (pRollback -> remotesumtick > pRollback -> checked && pRollback -> remotesumtick < nConfirmed &&
+        pRollback -> remotesumtick >= pRollback -> frame - ROLLBACK_HISTORY) {
+        if (pRollback -> sums[pRollback -> remotesumtick & (ROLLBACK_HISTORY - 1)] != pRollback -> remotesum) {
+            if (pRollback -> desyncs++ == 0)
+                pRollback -> firstdesync = pRollback -> remotesumtick;
+        }
+        pRollback -> checked = pRollback -> remotesumtick;
+    }
+
+    return nResult;
+}
+
+/**
+ * Plays the next tick with a local input, after correcting earlier ticks
+ * if need be. Returns 1 if the tick was played, 0 if the game has to wait
+ * for the peer this time and -1 if the state to go back to was lost.
+ *
+ * Parameters:
+ * pRollback	Game
+ * nInput		INPUT_* buttons of the local player
+ */
+int rollbackAdvance(ROLLBACK * pRollback, int nInput) {
+    long nFrame = pRollback -> frame;
+    long nAdvantage;
+
+    if (rollbackCorrect(pRollback) < 0)
+        return -1;
+
+    // Too far past the peer's input, a wrong guess could not be undone
+    if (nFrame - pRollback -> remoteknown >= ROLLBACK_WINDOW) {
+        pRollback -> stalls++;
+        return 0;
+    }
+
+    // The peer has not had local inputs the history no longer holds
+    if (pRollback -> localknown - pRollback -> remoteacked >= ROLLBACK_HISTORY - 1) {
+        pRollback -> stalls++;
+        return 0;
+    }
+
+    // Both sides see the other late by the same latency, so half the
+    // difference is how far this side is really ahead. Waiting at one tick
+    // ahead has both sides take turns waiting, so wait at one and a half.
+    if (nFrame - pRollback -> lastsync >= ROLLBACK_SYNC_EVERY) {
+        nAdvantage = nFrame - pRollback -> remoteframe;
+        if (nAdvantage - pRollback -> remoteadvantage >= 3) {
+            pRollback -> lastsync = nFrame;
+            pRollback -> waits++;
+            return 0;
+        }
+    }
+
+    pRollback -> inputs[pRollback -> local][(nFrame + pRollback -> delay) & (ROLLBACK_HISTORY - 1)] =
+        (unsigned char)(nInput & ((1 << INPUT_BITS) - 1));
+    pRollback -> localknown = nFrame + pRollback -> delay + 1;
+
+    if (rollbackSave(pRollback, nFrame) != 0)
+        return -1;
+
+    rollbackStep(pRollback, nFrame);
+    pRollback -> frame++;
+
+    return 1;
+}
+
+/**
+ * Builds the packet to send to the peer: every local input it has not
+ * acknowledged, what this side has of its inputs and the checksum of the
+ * last tick both know all input for. Sent every tick, so a lost packet is
+ * made up for by the next. Returns the size of the packet.
+ *
+ * Parameters:
+ * pRollback	Game
+ * pBuf			Receives the packet
+ * nCap			Size of the buffer, at least ROLLBACK_HEADER
+ */
+int rollbackPacket(ROLLBACK * pRollback, unsigned char * pBuf, int nCap) {
+    unsigned char * p = pBuf;
+    long nFirst = pRollback -> remoteacked;
+    long nCount = pRollback -> localknown - nFirst;
+    long nSumTick = rollbackConfirmed(pRollback) - 1;
+    long i;
+
+    if (nCount > nCap - ROLLBACK_HEADER)
+        nCount = nCap - ROLLBACK_HEADER;
+
+    memcpy(p, s_szMagic, 4);
+    p += 4;
+    p = putLong(p, pRollback -> frame);
+    p = putLong(p, pRollback -> remoteknown);
+    p = putLong(p, pRollback -> frame - pRollback -> remoteframe);
+    p = putLong(p, nSumTick);
+    p = putLong(p, nSumTick >= 0 ? (long) pRollback -> sums[nSumTick & (ROLLBACK_HISTORY - 1)] : 0);
+    p = putLong(p, nFirst);
+    * p++ = (unsigned char)(nCount & 0xFF);
+    * p++ = (unsigned char)((nCount >> 8) & 0xFF);
+
+    for (i = 0; i < nCount; i++)
+        * p++ = pRollback -> inputs[pRollback -> local][(nFirst + i) & (ROLLBACK_HISTORY - 1)];
+
+    return (int)(p - pBuf);
+}
+
+/**
+ * Takes in a packet from the peer. Inputs are taken in order only, and an
+ * input that differs from the guess a tick was played with marks the game
+ * to be corrected from that tick. Returns -1 if the packet is not valid.
+ *
+ * Parameters:
+ * pRollback	Game
+ * pData		Packet
+ * nSize		Size of the packet
+ */
+int rollbackReceive(ROLLBACK * pRollback, const unsigned char * pData, int nSize) {
+    const unsigned char * p = pData + 4;
+    int nRemote = 1 - pRollback -> local;
+    long nFrame, nAck, nAdvantage, nSumTick, nSum, nFirst;
+    int nCount, nSlot, nInput;
+    long t;
+    int i;
+
+    if (nSize < ROLLBACK_HEADER || memcmp(pData, s_szMagic, 4) != 0)
+        return -1;
+
+    p = getLong(p, & nFrame);
+    p = getLong(p, & nAck);
+    p = getLong(p, & nAdvantage);
+    p = getLong(p, & nSumTick);
+    p = getLong(p, & nSum);
+    p = getLong(p, & nFirst);
+    nCount = p[0] | (p[1] << 8);
+    p += 2;
+
+    if (nCount > nSize - ROLLBACK_HEADER || nFirst < 0)
+        return -1;
+
+    // Packets can arrive out of order, only the newest tells where the
+    // peer is
+    if (nFrame > pRollback -> remoteframe) {
+        pRollback -> remoteframe = nFrame;
+        pRollback -> remoteadvantage = nAdvantage;
+    }
+
+    if (nAck > pRollback -> remoteacked)
+        pRollback -> remoteacked = nAck < pRollback -> localknown ? nAck : pRollback -> localknown;
+
+    if (nSumTick > pRollback -> remotesumtick) {
+        pRollback -> remotesumtick = nSumTick;
+        pRollback -> remotesum = (unsigned int) nSum;
+    }
+
+    for (i = 0; i < nCount; i++) {
+        t = nFirst + i;
+        if (t < pRollback -> remoteknown)
+            continue;
+
+        // A gap, or further ahead than the history can hold yet
+        if (t > pRollback -> remoteknown || t >= pRollback -> frame + ROLLBACK_HISTORY - ROLLBACK_WINDOW - 2)
+            break;
+
+        nSlot = (int)(t & (ROLLBACK_HISTORY - 1));
+        nInput = p[i] & ((1 << INPUT_BITS) - 1);
+        pRollback -> inputs[nRemote][nSlot] = (unsigned char) nInput;
+
+        if (t < pRollback -> frame) {
+            if (pRollback -> used[nSlot] != nInput) {
+                pRollback -> mispredicted++;
+                if (pRollback -> rollbackto < 0 || t < pRollback -> rollbackto)
+                    pRollback -> rollbackto = t;
+            } else {
+                pRollback -> predicted++;
+            }
+        }
+
+        pRollback -> remoteknown++;
+    }
+
+    return 0;
+}
+
+/**
+ * Returns the number of ticks from the start played with the actual inputs
+ * of both players, which will not change again
+ *
+ * Parameters:
+ * pRollback	Game
+ */
+long rollbackConfirmed(const ROLLBACK * pRollback) {
+    long nConfirmed = pRollback -> remoteknown < pRollback -> frame ? pRollback -> remoteknown : pRollback -> frame;
+
+    if (pRollback -> rollbackto >= 0 && pRollback -> rollbackto < nConfirmed)
+        nConfirmed = pRollback -> rollbackto;
+
+    return nConfirmed;
+}
+
+/**
+ * Returns the input of both players for a recent confirmed tick, as
+ * simTick takes it
+ *
+ * Parameters:
+ * pRollback	Game
+ * nTick		Tick, below rollbackConfirmed and within the history
+ */
+int rollbackInput(const ROLLBACK * pRollback, long nTick) {
+    int nSlot = (int)(nTick & (ROLLBACK_HISTORY - 1));
+
+    return pRollback -> inputs[PLAYER][nSlot] | (pRollback -> inputs[RIVAL][nSlot] << INPUT_BITS);
+}
+
+/**
+ * Returns the checksum after a recent tick
+ *
+ * Parameters:
+ * pRollback	Game
+ * nTick		Tick, within the history
+ */
+unsigned int rollbackChecksum(const ROLLBACK * pRollback, long nTick) {
+    return pRollback -> sums[nTick & (ROLLBACK_HISTORY - 1)];
+}
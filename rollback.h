@@ -0,0 +1,114 @@
+/**
+ * File:        rollback.h
+ * Purpose:     Header file for rollback.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _ROLLBACK_H_
+#define _ROLLBACK_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Most ticks played past the last input known from the peer, the deepest
+// a rollback can go
+#define ROLLBACK_WINDOW 12
+
+// Ticks of input kept, a power of two, bounds the input delay and how far
+// the peer can fall behind in acknowledging
+#define ROLLBACK_HISTORY 64
+
+// Snapshots kept, one per tick that might be played again
+#define ROLLBACK_SNAPS (ROLLBACK_WINDOW + 2)
+
+// Most ticks of input delay
+#define ROLLBACK_DELAY_MAX 8
+
+// Ticks between waits to let a peer that is behind catch up
+#define ROLLBACK_SYNC_EVERY 20
+
+// Bytes ahead of the inputs in a packet
+#define ROLLBACK_HEADER 30
+
+// Largest packet built
+#define ROLLBACK_PACKET_MAX (ROLLBACK_HEADER + ROLLBACK_HISTORY)
+
+// Snapshot of the state ahead of one tick
+typedef struct ROLLBACKSNAP
+{
+	void * data;
+	size_t size;
+	size_t cap;
+	long tick;
+} ROLLBACKSNAP;
+
+// A two-player game kept in step with a peer's copy. Each side plays on
+// with the peer's last input repeated and, when the actual input turns
+// out different, goes back to that tick and plays the ticks since again.
+typedef struct ROLLBACK
+{
+	int local;
+	int delay;
+
+	// Next tick to play
+	long frame;
+
+	// Inputs are known for the ticks below these, the peer's without gaps
+	long localknown;
+	long remoteknown;
+
+	// The peer has the local inputs below this
+	long remoteacked;
+
+	// Tick the peer was at, and how far ahead of us it thought it was,
+	// when it last sent
+	long remoteframe;
+	long remoteadvantage;
+	long lastsync;
+
+	// Earliest tick played with a wrong guess, -1 for none
+	long rollbackto;
+
+	// Inputs of both players, the peer input each tick was played with and
+	// the checksum after it, by tick
+	unsigned char inputs[2][ROLLBACK_HISTORY];
+	unsigned char used[ROLLBACK_HISTORY];
+	unsigned int sums[ROLLBACK_HISTORY];
+
+	// Checksum the peer had after a tick both sides know all input for
+	long remotesumtick;
+	unsigned int remotesum;
+	long checked;
+
+	ROLLBACKSNAP snaps[ROLLBACK_SNAPS];
+
+	// Totals, for measuring
+	long rollbacks;
+	long resimulated;
+	long deepest;
+	double resimtime;
+	long saves, loads;
+	double savetime, loadtime;
+	long predicted, mispredicted;
+	long stalls, waits;
+	long desyncs;
+	long firstdesync;
+} ROLLBACK;
+
+// Function declarations
+ROLLBACK * rollbackCreate(int nLocal, int nDelay);
+void rollbackFree(ROLLBACK * pRollback);
+int rollbackAdvance(ROLLBACK * pRollback, int nInput);
+int rollbackCorrect(ROLLBACK * pRollback);
+int rollbackPacket(ROLLBACK * pRollback, unsigned char * pBuf, int nCap);
+int rollbackReceive(ROLLBACK * pRollback, const unsigned char * pData, int nSize);
+long rollbackConfirmed(const ROLLBACK * pRollback);
+int rollbackInput(const ROLLBACK * pRollback, long nTick);
+unsigned int rollbackChecksum(const ROLLBACK * pRollback, long nTick);
+
+#endif
@@ -0,0 +1,1270 @@
+/**
+ * File:        sim.c
+ * Purpose:     Game simulation, free of any graphics, sound or input code
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include "sim.h"
+
+// Current player information
+SIM_LOCAL int g_nPlayerScore = 0;
+SIM_LOCAL int g_nRivalScore = 0;
+SIM_LOCAL int g_bVictory = 0;
+
+// Players in the game, from the next reset on
+SIM_LOCAL int g_nPlayers = 1;
+SIM_LOCAL int g_nTimeLeft = 90;
+
+// Ticks played since the time limit last went down
+SIM_LOCAL int g_nSecondTicks = 0;
+
+// Which slots of the distant actors are updated this tick
+SIM_LOCAL int g_nDetailPhase = 0;
+
+// Distant actors are updated one tick in this many, set by simDetailRate
+static SIM_LOCAL int s_nDetailEvery = SIM_DETAIL_EVERY;
+
+// Map information
+SIM_LOCAL int g_nMapX = 0;
+SIM_LOCAL int g_nMapY = 0;
+
+// Lanes of the awake list where each partition of the tick starts
+static SIM_LOCAL int s_aSeams[WORKER_MAX + 1];
+static SIM_LOCAL int s_nParts = 1;
+
+// Threads started by simThreads
+static SIM_LOCAL int s_nThreads = 1;
+
+// Events raised by each partition, merged in order once they are all done
+static SIM_LOCAL EVENTQUEUE s_aPartEvents[WORKER_MAX];
+
+// Where each player's camera looks this tick, plants wake when any sees them
+static SIM_LOCAL int s_aViewX[MAX_PLAYERS];
+static SIM_LOCAL int s_aViewY[MAX_PLAYERS];
+
+// Awake actors with each partition sorted by kind, and where the run of
+// each kind starts: kind k of partition p is lanes s_aRuns[p][k] up to
+// s_aRuns[p][k + 1]. Actors are moved in this order.
+static SIM_LOCAL int * s_pOrder = NULL;
+static SIM_LOCAL int s_nOrderCap = 0;
+static SIM_LOCAL int s_aRuns[WORKER_MAX][NUM_KINDS + 1];
+
+// Actors stepped by the pass being run, the awake list or those of them
+// still owed ticks
+static SIM_LOCAL int * s_pStep = NULL;
+static SIM_LOCAL int s_nStep = 0;
+
+// Actors that caught up on ticks this tick, where each stood when the
+// tick began, and room for the actors of one catch-up pass
+static SIM_LOCAL int * s_pOwed = NULL;
+static SIM_LOCAL int * s_pOwedX = NULL;
+static SIM_LOCAL int * s_pOwedY = NULL;
+static SIM_LOCAL int * s_pCatchUp = NULL;
+static SIM_LOCAL int s_nOwed = 0;
+static SIM_LOCAL int s_nOwedCap = 0;
+
+// Kernels that update a run of actors of one kind
+typedef struct KINDKERNELS
+{
+	// Decides where the actors go, NULL for none
+	void (* think)(const int * pSlots, int nCount);
+
+	// Checks the actors against the tiles
+	void (* collide)(const int * pSlots, int nCount, EVENTQUEUE * pEvents);
+} KINDKERNELS;
+
+// Plants of the original level, for maps without spawner blocks
+static const SPAWNER s_aPlants[] = {
+    { PLANT_W * 10, 100, KIND_PLANT, 0 },
+    { PLANT_W * 52, 100, KIND_PLANT, 0 },
+    { PLANT_W * 41, 700, KIND_PLANT, 0 },
+    { PLANT_W * 60, 100, KIND_PLANT, 0 }
+};
+
+/**
+ * Checks for a collision with interactable objects on the map at given screen coordinates
+ *
+ * Parameters:
+ * nPlayer		Slot of the player checking
+ * x			X coordinate
+ * y			Y coordinate
+ */
+static int objectCheck(int nPlayer, int x, int y) {
+    int * pScore = nPlayer == PLAYER ? & g_nPlayerScore : & g_nRivalScore;
+    // Find the tile
+    LEVELBLK * pBlock;
+
+    if (x < 0 || y < 0 || x >= g_pLevel -> width * TILE_SIZE || y >= g_pLevel -> height * TILE_SIZE)
+        return 0;
+
+    pBlock = levelGetBlock(x / TILE_SIZE, y / TILE_SIZE);
+
+    if (pBlock -> flags & BLK_GOAL) // End of game
+    {
+        // Add score
+        * pScore += 150;
+
+        // Victory, the caller ends the player's game
+        g_bVictory = 1;
+
+        eventPush( & g_sEvents, EVENT_VICTORY, nPlayer, x, y, 150);
+
+        return 2;
+    }
+
+    if (pBlock -> flags & BLK_GEM) // Gem pickup
+    {
+        // Add score
+        * pScore += pBlock -> value;
+
+        eventPush( & g_sEvents, EVENT_GEM, nPlayer, x / TILE_SIZE * TILE_SIZE, y / TILE_SIZE * TILE_SIZE, pBlock -> value);
+
+        // Set taken
+        levelSetBlock(x / TILE_SIZE, y / TILE_SIZE, 0);
+        return 1;
+    } else {
+        return 0;
+    }
+}
+
+/**
+ * Sets up a new plant, dormant until the camera first sees it
+ *
+ * Parameters:
+ * i			Slot of the plant
+ * x			X coordinate
+ * y			Y coordinate
+ */
+static void plantSpawn(int i, int x, int y) {
+    g_sActors.frame[i] = 0;
+    g_sActors.framecount[i] = 0;
+    g_sActors.framedelay[i] = 13;
+    g_sActors.maxframe[i] = 2;
+    g_sActors.alive[i] = 1;
+    g_sActors.w[i] = PLANT_W;
+    g_sActors.h[i] = PLANT_H;
+
+    g_sActors.jump[i] = JUMPIT;
+    g_sActors.x[i] = x;
+    g_sActors.y[i] = y;
+    g_sActors.dir[i] = 0;
+}
+
+/**
+ * Creates an actor for a spawner and lists it in its region
+ *
+ * Parameters:
+ * nKind		KIND_* of the actor
+ * x			X coordinate
+ * y			Y coordinate
+ */
+static ACTOR spawnActor(int nKind, int x, int y) {
+    ACTOR hActor;
+    int i;
+
+    if (nKind != KIND_PLANT)
+        return ACTOR_NONE;
+
+    hActor = actorSpawn(nKind);
+    i = actorIndex(hActor);
+    if (i < 0)
+        return ACTOR_NONE;
+
+    plantSpawn(i, x, y);
+
+    // Nothing to interpolate from yet
+    g_sActors.oldx[i] = x;
+    g_sActors.oldy[i] = y;
+
+    regionInsert(i);
+
+    return hActor;
+}
+
+/**
+ * Resets the players to start a new game. Each is spawned in turn into an
+ * empty pool, so player n keeps slot n.
+ */
+static void playerReset(void) {
+    int p;
+
+    // Start over with an empty pool, the players take the first slots
+    actorClear();
+    regionReset();
+
+    for (p = 0; p < g_nPlayers; p++) {
+        actorSpawn(KIND_PLAYER);
+
+        g_sActors.frame[p] = 0;
+        g_sActors.framecount[p] = 0;
+        g_sActors.framedelay[p] = 5;
+        g_sActors.maxframe[p] = 7;
+        g_sActors.alive[p] = 1;
+        g_sActors.w[p] = PLAYER_W;
+        g_sActors.h[p] = PLAYER_H;
+
+        // Position the player, side by side
+        g_sActors.x[p] = g_sActors.w[p] * (1 + 2 * p);
+        g_sActors.y[p] = 100;
+        g_sActors.jump[p] = JUMPIT;
+        regionInsert(p);
+    }
+
+    g_bVictory = 0;
+    g_nDetailPhase = 0;
+
+    // Reset score
+    g_nPlayerScore = 0;
+    g_nRivalScore = 0;
+    g_nTimeLeft = 90;
+    g_nSecondTicks = 0;
+
+    // Plants come from the spawners as the players get near
+}
+
+/**
+ * Points each player's camera at them, and returns the span of the map
+ * the cameras look at
+ *
+ * Parameters:
+ * pLeft		Receives the left edge of the leftmost view
+ * pRight		Receives the right edge of the rightmost view
+ */
+static void simViews(int * pLeft, int * pRight) {
+    int p;
+
+    * pLeft = MAP_WIDTH * 32;
+    * pRight = 0;
+
+    for (p = 0; p < g_nPlayers; p++) {
+        cameraFollow(g_sActors.x[p], g_sActors.y[p], g_sActors.w[p], g_sActors.h[p], & s_aViewX[p], & s_aViewY[p]);
+
+        if (s_aViewX[p] < * pLeft)
+            * pLeft = s_aViewX[p];
+        if (s_aViewX[p] + VIEW_W > * pRight)
+            * pRight = s_aViewX[p] + VIEW_W;
+    }
+}
+
+/**
+ * Returns nonzero if an actor is close enough to any player's view to be
+ * updated every tick
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+static int actorNear(int i) {
+    int p;
+
+    for (p = 0; p < g_nPlayers; p++) {
+        if (g_sActors.x[i] - s_aViewX[p] > -g_sActors.w[i] - SIM_DETAIL_MARGIN &&
+            g_sActors.x[i] - s_aViewX[p] < VIEW_W + g_sActors.w[i] + SIM_DETAIL_MARGIN &&
+            g_sActors.y[i] - s_aViewY[p] > -g_sActors.h[i] - SIM_DETAIL_MARGIN &&
+            g_sActors.y[i] - s_aViewY[p] < VIEW_H + g_sActors.h[i] + SIM_DETAIL_MARGIN)
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Drops the distant actors whose turn it is not from the awake list, so
+ * the tick only pays in full for what is near a view. Each dropped actor
+ * is owed the tick, and steps it when its turn comes or it comes near.
+ * The list keeps its column order. Players are always updated, and
+ * nothing this far away can be seen or touch them.
+ */
+static void simDetail(void) {
+    int i, n, nKept = 0;
+
+    if (s_nDetailEvery > 1) {
+        for (n = 0; n < g_nAwake; n++) {
+            i = g_pAwake[n];
+            if (g_sActors.kind[i] == KIND_PLAYER || (i + g_nDetailPhase) % s_nDetailEvery == 0 || actorNear(i))
+                g_pAwake[nKept++] = i;
+            else if (g_sActors.owed[i] < s_nDetailEvery - 1) // No more than a turn's worth
+                g_sActors.owed[i]++;
+        }
+        g_nAwake = nKept;
+    }
+
+    if (++g_nDetailPhase >= s_nDetailEvery)
+        g_nDetailPhase = 0;
+}
+
+/**
+ * Splits the actors of the pass into runs of whole map columns, one per
+ * worker thread, as long as each gets enough of them. The awake list is
+ * gathered column by column, so each run is a range of the map.
+ */
+static void simPartition(void) {
+    int nParts = s_nThreads;
+    int p, n;
+
+    if (nParts > s_nStep / SIM_PARALLEL_MIN)
+        nParts = s_nStep / SIM_PARALLEL_MIN;
+    if (nParts < 1)
+        nParts = 1;
+
+    s_aSeams[0] = 0;
+    for (p = 1; p < nParts; p++) {
+        n = (int)((long) s_nStep * p / nParts);
+        if (n < s_aSeams[p - 1])
+            n = s_aSeams[p - 1];
+
+        // Start of the next column
+        while (n > 0 && n < s_nStep && g_sActors.region[s_pStep[n]] == g_sActors.region[s_pStep[n - 1]])
+            n++;
+
+        s_aSeams[p] = n < s_nStep ? n : s_nStep;
+    }
+    s_aSeams[nParts] = s_nStep;
+
+    s_nParts = nParts;
+}
+
+/**
+ * Sorts the actors of each partition of the pass by kind, so every kind's
+ * kernels run over a run of its own. Actors of a kind keep their order.
+ * Returns -1 if out of memory.
+ */
+static int simSortKinds(void) {
+    int aNext[NUM_KINDS];
+    int * pNew;
+    int nCap;
+    int p, k, n, i;
+
+    if (s_nStep > s_nOrderCap) {
+        nCap = s_nOrderCap ? s_nOrderCap : 256;
+        while (nCap < s_nStep)
+            nCap *= 2;
+
+        pNew = realloc(s_pOrder, nCap * sizeof(int));
+        if (pNew == NULL)
+            return -1;
+
+        s_pOrder = pNew;
+        s_nOrderCap = nCap;
+    }
+
+    for (p = 0; p < s_nParts; p++) {
+        for (k = 0; k < NUM_KINDS; k++)
+            aNext[k] = 0;
+        for (n = s_aSeams[p]; n < s_aSeams[p + 1]; n++)
+            aNext[g_sActors.kind[s_pStep[n]]]++;
+
+        s_aRuns[p][0] = s_aSeams[p];
+        for (k = 0; k < NUM_KINDS; k++) {
+            s_aRuns[p][k + 1] = s_aRuns[p][k] + aNext[k];
+            aNext[k] = s_aRuns[p][k];
+        }
+
+        for (n = s_aSeams[p]; n < s_aSeams[p + 1]; n++) {
+            i = s_pStep[n];
+            s_pOrder[aNext[g_sActors.kind[i]]++] = i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Steps the animation of the living, moving actors of one partition
+ *
+ * Parameters:
+ * pData		Unused
+ * nPart		Partition to animate
+ */
+static void animatePart(void * pData, int nPart) {
+    int i, n;
+
+    (void) pData;
+
+    for (n = s_aSeams[nPart]; n < s_aSeams[nPart + 1]; n++) {
+        i = s_pOrder[n];
+
+        // Next frame once the delay has passed, back to 1 after the last
+        if (g_sActors.alive[i] && g_sActors.moving[i] && ++g_sActors.framecount[i] > g_sActors.framedelay[i]) {
+            g_sActors.framecount[i] = 0;
+            if (++g_sActors.frame[i] > g_sActors.maxframe[i])
+                g_sActors.frame[i] = 1;
+        }
+    }
+}
+
+/**
+ * Lands a falling actor that has reached the ground. Returns nonzero if
+ * it landed on a spike.
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+static int actorLand(int i) {
+    // Check for solid blocks
+    if (!mapCollision(g_sActors.x[i] + g_sActors.w[i] / 2, g_sActors.y[i] + g_sActors.h[i])) {
+        g_sActors.jump[i] = 0;
+        return spikeCheck(g_sActors.x[i] + g_sActors.w[i] / 2, g_sActors.y[i] + g_sActors.h[i]);
+    }
+
+    return 0;
+}
+
+/**
+ * Ends the jump of an actor that has come down into the ground, lifting
+ * it out
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+static void actorSettle(int i) {
+    if (mapCollision(g_sActors.x[i] + g_sActors.w[i] / 2, g_sActors.y[i] + g_sActors.h[i])) {
+        g_sActors.jump[i] = JUMPIT;
+        while (mapCollision(g_sActors.x[i] + g_sActors.w[i] / 2, g_sActors.y[i] + g_sActors.h[i]))
+            g_sActors.y[i] -= 2;
+    }
+}
+
+/**
+ * Puts an actor that walked into a wall back where it was. Returns
+ * nonzero if it did.
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+static int actorBlock(int i) {
+    int nEdgeX; // Leading edge of the sprite
+    int bBlocked; // Whether a wall was hit
+
+    // Check collision on the leading edge of sprite at foot height
+    nEdgeX = g_sActors.dir[i] ? g_sActors.x[i] + g_sActors.w[i] : g_sActors.x[i];
+    bBlocked = mapCollision(nEdgeX, g_sActors.y[i] + g_sActors.h[i]);
+
+    // Check the whole body for walls it has just moved into
+    if (!bBlocked && g_sActors.x[i] != g_sActors.oldx[i]) {
+        bBlocked = collisionBox(g_sActors.x[i], g_sActors.y[i], g_sActors.w[i], g_sActors.h[i]) &&
+            !collisionBox(g_sActors.oldx[i], g_sActors.y[i], g_sActors.w[i], g_sActors.h[i]);
+    }
+
+    if (bBlocked)
+        g_sActors.x[i] = g_sActors.oldx[i];
+
+    return bBlocked;
+}
+
+/**
+ * Checks a run of players against the tiles: they die on spikes, jump
+ * when asked and stop at walls
+ *
+ * Parameters:
+ * pSlots		Slots of the players
+ * nCount		Number of players
+ * pEvents		Receives what happened
+ */
+static void playerCollide(const int * pSlots, int nCount, EVENTQUEUE * pEvents) {
+    int i, n;
+
+    for (n = 0; n < nCount; n++) {
+        i = pSlots[n];
+
+        // Player is falling, not jumping
+        if (g_sActors.jump[i] == JUMPIT) {
+            if (actorLand(i)) // Kill player if hitting a spike
+            {
+                // Only report it once
+                if (g_sActors.alive[i])
+                    eventPush(pEvents, EVENT_DEATH, i, g_sActors.x[i], g_sActors.y[i], 0);
+                g_sActors.alive[i] = 0;
+            }
+
+            // Player wants to jump
+            if (g_sActors.alive[i] && g_sActors.jumpqueued[i]) {
+                g_sActors.jump[i] = 32;
+                eventPush(pEvents, EVENT_JUMP, i, g_sActors.x[i], g_sActors.y[i], 0);
+            }
+        }
+
+        // End of jump
+        if (g_sActors.jump[i] < 0)
+            actorSettle(i);
+
+        actorBlock(i);
+    }
+}
+
+/**
+ * Checks a run of plants against the tiles: they die on spikes and turn
+ * around at walls
+ *
+ * Parameters:
+ * pSlots		Slots of the plants
+ * nCount		Number of plants
+ * pEvents		Unused, plants raise no events
+ */
+static void plantCollide(const int * pSlots, int nCount, EVENTQUEUE * pEvents) {
+    int i, n;
+
+    (void) pEvents;
+
+    for (n = 0; n < nCount; n++) {
+        i = pSlots[n];
+
+        if (g_sActors.jump[i] == JUMPIT && actorLand(i))
+            g_sActors.alive[i] = 0;
+
+        if (g_sActors.jump[i] < 0)
+            actorSettle(i);
+
+        if (actorBlock(i))
+            g_sActors.dir[i] = !g_sActors.dir[i];
+    }
+}
+
+/**
+ * Returns nonzero if an actor is in view of any player's camera
+ *
+ * Parameters:
+ * i			Slot of the actor
+ */
+static int actorVisible(int i) {
+    int p;
+
+    for (p = 0; p < g_nPlayers; p++) {
+        if (g_sActors.x[i] - s_aViewX[p] > -g_sActors.w[i] && g_sActors.x[i] - s_aViewX[p] < VIEW_W + g_sActors.w[i] &&
+            g_sActors.y[i] - s_aViewY[p] > -g_sActors.h[i] && g_sActors.y[i] - s_aViewY[p] < VIEW_H + g_sActors.h[i])
+            return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Decides on AI movement for a run of plants, each walks until it would
+ * fall into danger. Only changes the plants themselves.
+ *
+ * Parameters:
+ * pSlots		Slots of the plants
+ * nCount		Number of plants
+ */
+static void plantThink(const int * pSlots, int nCount) {
+    int tmpY;
+    int unsafe;
+    int i, n;
+
+    for (n = 0; n < nCount; n++) {
+        i = pSlots[n];
+
+        // Check if seen
+        if ((!g_sActors.active[i]) && actorVisible(i))
+            g_sActors.active[i] = 1;
+
+        // Don't move if jumping or never seen
+        if (g_sActors.jump[i] == 0 && g_sActors.active[i]) {
+            // Move in current direction
+            g_sActors.moving[i] = 1;
+            if (g_sActors.dir[i]) {
+                g_sActors.x[i] += 5;
+            } else {
+                g_sActors.x[i] -= 5;
+            }
+        }
+
+        // Check for dangers
+        tmpY = g_sActors.y[i];
+        unsafe = 0;
+
+        // Simulate a fall
+        while (!mapCollision(g_sActors.x[i] + g_sActors.w[i] / 2, tmpY + g_sActors.h[i])) {
+            tmpY += 2;
+            if (tmpY > 730) // Check for falling off map
+            {
+                unsafe = 1;
+                break;
+            }
+
+            if (spikeCheck(g_sActors.x[i] + g_sActors.w[i] / 2, tmpY + g_sActors.h[i])) // Check for spikes
+            {
+                unsafe = 1;
+            }
+        }
+
+        // If unsafe, reverse direction
+        if (unsafe) {
+            if (g_sActors.dir[i]) {
+                g_sActors.dir[i] = 0;
+                g_sActors.x[i] -= 10;
+            } else {
+                g_sActors.dir[i] = 1;
+                g_sActors.x[i] += 10;
+            }
+        }
+    }
+}
+
+// Update kernels of each kind, indexed by KIND_*. A kind only pays for
+// its own rules, adding one leaves the loops of the others alone.
+static const KINDKERNELS s_aKernels[NUM_KINDS] = {
+    { NULL, playerCollide }, // KIND_PLAYER, moved by input
+    { plantThink, plantCollide } // KIND_PLANT
+};
+
+/**
+ * Moves the actors of one partition along their arcs, against the tiles
+ * and inside the map. Only reads the map, so partitions can run together.
+ *
+ * Parameters:
+ * pData		Unused
+ * nPart		Partition to move
+ */
+static void physicsPart(void * pData, int nPart) {
+    EVENTQUEUE * pEvents = & s_aPartEvents[nPart];
+    int k, n, i;
+
+    (void) pData;
+
+    eventClear(pEvents);
+
+    // Actors in the air follow their arc. Actors resting on the ground
+    // (jump is JUMPIT) are left for the tiles.
+    for (n = s_aSeams[nPart]; n < s_aSeams[nPart + 1]; n++) {
+        i = s_pOrder[n];
+        if (g_sActors.jump[i] != JUMPIT) {
+            g_sActors.y[i] -= g_sActors.jump[i] / 3;
+            g_sActors.jump[i]--;
+        }
+    }
+
+    // Each kind's run against the tiles, by its own rules
+    for (k = 0; k < NUM_KINDS; k++)
+        s_aKernels[k].collide(s_pOrder + s_aRuns[nPart][k], s_aRuns[nPart][k + 1] - s_aRuns[nPart][k], pEvents);
+
+    for (n = s_aSeams[nPart]; n < s_aSeams[nPart + 1]; n++) {
+        i = s_pOrder[n];
+
+        // Check collisions with edges, NPCs turn around
+        if (g_sActors.x[i] < 0) {
+            g_sActors.x[i] = 0;
+            if (g_sActors.kind[i] != KIND_PLAYER)
+                g_sActors.dir[i] = 1;
+        } else if (g_sActors.x[i] > (MAP_WIDTH - 1) * 32) {
+            g_sActors.x[i] = (MAP_WIDTH - 1) * 32;
+            if (g_sActors.kind[i] != KIND_PLAYER)
+                g_sActors.dir[i] = 0;
+        }
+
+        // Fell off the map, or clamp to the top. Only report players
+        // falling off once.
+        if (g_sActors.y[i] > 740) {
+            if (g_sActors.alive[i] && g_sActors.kind[i] == KIND_PLAYER)
+                eventPush(pEvents, EVENT_DEATH, i, g_sActors.x[i], g_sActors.y[i], 0);
+            g_sActors.alive[i] = 0;
+            g_sActors.jump[i] = JUMPIT;
+        } else if (g_sActors.y[i] < -g_sActors.h[i]) {
+            g_sActors.y[i] = -g_sActors.h[i];
+        }
+    }
+}
+
+/**
+ * Moves the actors of the pass, according to rules and physics. Each partition
+ * only touches its own actors, whatever reaches across the map (gems, the
+ * player, events) is done here in between, in the same order as on a
+ * single thread. Returns -1 if out of memory.
+ */
+static int moveActors(void) {
+    int i, j, n;
+    int p;
+    int nPairs; // Candidate collision pairs
+    BPPAIR * pPairs;
+
+    // Loop through frames in the animation
+    workerRun(animatePart, NULL, s_nParts);
+
+    // Only players pick up gems, which changes the map
+    for (p = 0; p < s_nParts; p++) {
+        for (n = s_aRuns[p][KIND_PLAYER]; n < s_aRuns[p][KIND_PLAYER + 1]; n++) {
+            i = s_pOrder[n];
+            if (g_sActors.alive[i] && objectCheck(i, g_sActors.x[i] + g_sActors.w[i] / 2, g_sActors.y[i] + g_sActors.h[i]) == 2) // Take any gems
+                g_sActors.alive[i] = 0; // No longer alive, but victory
+        }
+    }
+
+    workerRun(physicsPart, NULL, s_nParts);
+
+    for (p = 0; p < s_nParts; p++)
+        eventAppend( & g_sEvents, & s_aPartEvents[p]);
+
+    // Gather candidate pairs among living actors
+    broadphaseClear();
+    for (n = 0; n < s_nStep; n++) {
+        i = s_pStep[n];
+        if (g_sActors.alive[i])
+            broadphaseInsert(i, g_sActors.x[i], g_sActors.y[i], g_sActors.w[i], g_sActors.h[i]);
+    }
+    nPairs = broadphasePairs( & pPairs);
+    if (nPairs < 0)
+        return -1;
+
+    // Check player collisions
+    for (j = 0; j < nPairs; j++) {
+        // Only plants touching a player matter for now. Players hold the
+        // lowest slots, so they come first in a pair.
+        p = pPairs[j].a;
+        i = pPairs[j].b;
+        if (g_sActors.kind[p] != KIND_PLAYER || g_sActors.kind[i] == KIND_PLAYER)
+            continue;
+
+        if (abs(g_sActors.y[i] - g_sActors.y[p]) < g_sActors.h[i] / 2) // Vertical collision
+        {
+            if (abs(g_sActors.x[i] - g_sActors.x[p]) < g_sActors.w[i] / 2) // Horizontal collision
+            {
+                // Kill player
+                if (g_sActors.alive[p]) {
+                    eventPush( & g_sEvents, EVENT_DEATH, p, g_sActors.x[p], g_sActors.y[p], 0);
+                    g_sActors.alive[p] = 0;
+                    g_sActors.jump[p] = JUMPIT;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Decides on AI movement for the awake actors of one partition, kind by
+ * kind
+ *
+ * Parameters:
+ * pData		Unused
+ * nPart		Partition to decide for
+ */
+static void aiPart(void * pData, int nPart) {
+    int k;
+
+    (void) pData;
+
+    for (k = 0; k < NUM_KINDS; k++)
+        if (s_aKernels[k].think != NULL)
+            s_aKernels[k].think(s_pOrder + s_aRuns[nPart][k], s_aRuns[nPart][k + 1] - s_aRuns[nPart][k]);
+}
+
+/**
+ * Decides on AI movement for awake NPCs
+ */
+static void aiMovement(void) {
+    workerRun(aiPart, NULL, s_nParts);
+}
+
+/**
+ * Runs one step of the tick over a list of actors in column order,
+ * returns -1 if out of memory
+ *
+ * Parameters:
+ * pSlots		Slots of the actors
+ * nCount		Number of actors
+ */
+static int simPass(int * pSlots, int nCount) {
+    s_pStep = pSlots;
+    s_nStep = nCount;
+
+    // Share the actors out between the worker threads, each kind in a
+    // run of its own
+    simPartition();
+    if (simSortKinds() != 0)
+        return -1;
+
+    aiMovement();
+
+    return moveActors();
+}
+
+/**
+ * Grows a list of ints, returns -1 if out of memory and leaves it as it
+ * was
+ *
+ * Parameters:
+ * ppList		List to grow
+ * nCap			Ints it should hold
+ */
+static int growList(int ** ppList, int nCap) {
+    int * pNew = realloc( * ppList, nCap * sizeof(int));
+
+    if (pNew == NULL)
+        return -1;
+
+    * ppList = pNew;
+    return 0;
+}
+
+/**
+ * Steps the awake actors owed ticks for the ticks they missed, the most
+ * owed first, so each is where it would have been had it never missed
+ * one. Each pass starts from where the last left the actor, which is
+ * where it goes back to when it is blocked. Returns -1 if out of memory.
+ */
+static int simCatchUp(void) {
+    int nCap;
+    int nPass;
+    int k, n, i;
+
+    if (g_nAwake > s_nOwedCap) {
+        nCap = s_nOwedCap ? s_nOwedCap : 256;
+        while (nCap < g_nAwake)
+            nCap *= 2;
+
+        if (growList( & s_pOwed, nCap) != 0 || growList( & s_pOwedX, nCap) != 0 ||
+            growList( & s_pOwedY, nCap) != 0 || growList( & s_pCatchUp, nCap) != 0)
+            return -1;
+
+        s_nOwedCap = nCap;
+    }
+
+    // The actors owed ticks, and where they stood when the tick began
+    s_nOwed = 0;
+    for (n = 0; n < g_nAwake; n++) {
+        i = g_pAwake[n];
+        if (g_sActors.owed[i] > 0 && g_sActors.alive[i]) {
+            s_pOwed[s_nOwed] = i;
+            s_pOwedX[s_nOwed] = g_sActors.x[i];
+            s_pOwedY[s_nOwed] = g_sActors.y[i];
+            s_nOwed++;
+        }
+    }
+
+    // An actor owed k ticks takes part in the passes for k down to 1,
+    // those that died on the way sit the rest out
+    for (k = s_nDetailEvery - 1; k > 0; k--) {
+        nPass = 0;
+        for (n = 0; n < s_nOwed; n++) {
+            i = s_pOwed[n];
+            if (g_sActors.owed[i] >= k && g_sActors.alive[i]) {
+                g_sActors.oldx[i] = g_sActors.x[i];
+                g_sActors.oldy[i] = g_sActors.y[i];
+                s_pCatchUp[nPass++] = i;
+            }
+        }
+
+        if (nPass > 0 && simPass(s_pCatchUp, nPass) != 0)
+            return -1;
+    }
+
+    // The tick itself carries on from there
+    for (n = 0; n < s_nOwed; n++) {
+        i = s_pOwed[n];
+        g_sActors.oldx[i] = g_sActors.x[i];
+        g_sActors.oldy[i] = g_sActors.y[i];
+    }
+
+    for (n = 0; n < g_nAwake; n++)
+        g_sActors.owed[g_pAwake[n]] = 0;
+
+    return 0;
+}
+
+/**
+ * Puts the old locations of the actors that caught up back to where they
+ * stood when the tick began, so they are drawn moving from there
+ */
+static void simCaughtUp(void) {
+    int i, n;
+
+    for (n = 0; n < s_nOwed; n++) {
+        i = s_pOwed[n];
+        g_sActors.oldx[i] = s_pOwedX[n];
+        g_sActors.oldy[i] = s_pOwedY[n];
+    }
+}
+
+/**
+ * Points the camera at the given player position, kept inside the map.
+ * Only reads its arguments, so the renderer can use it too.
+ *
+ * Parameters:
+ * x			Player X coordinate
+ * y			Player Y coordinate
+ * w			Player width
+ * h			Player height
+ * pMapX		Receives the camera X coordinate
+ * pMapY		Receives the camera Y coordinate
+ */
+void cameraFollow(int x, int y, int w, int h, int * pMapX, int * pMapY) {
+    * pMapX = x + w / 2 - VIEW_W / 2;
+    * pMapY = y + h / 2 - VIEW_H / 2;
+
+    if ( * pMapX < 0)
+        * pMapX = 0;
+    if ( * pMapX > MAP_WIDTH * 32 - VIEW_W)
+        * pMapX = MAP_WIDTH * 32 - VIEW_W;
+
+    if ( * pMapY < 0)
+        * pMapY = 0;
+    if ( * pMapY > MAP_HEIGHT * 32 - VIEW_H)
+        * pMapY = MAP_HEIGHT * 32 - VIEW_H;
+}
+
+/**
+ * Loads a map and starts a new game on it. Returns 0 on success.
+ *
+ * Parameters:
+ * szMap		Path to the map file
+ */
+int simInit(const char * szMap) {
+    LEVEL * pLevel = levelLoad(szMap);
+
+    if (pLevel == NULL)
+        return -1;
+
+    // The derived data is built once per map
+    g_pLevel = pLevel;
+    collisionBuild();
+    navBuild();
+
+    return simStart(pLevel);
+}
+
+/**
+ * Starts a new game on a level whose collision plane and platform graph
+ * have been built. Returns 0 on success.
+ *
+ * Parameters:
+ * pLevel		Level to play, freed with the game
+ */
+int simStart(LEVEL * pLevel) {
+    g_pLevel = pLevel;
+
+    if (regionBuild(s_aPlants, sizeof(s_aPlants) / sizeof(s_aPlants[0])) != 0)
+        return -1;
+
+    simReset();
+
+    return 0;
+}
+
+/**
+ * Sets how many threads share the actor updates of a tick, the calling
+ * thread included. The result of a tick does not depend on it. Returns
+ * the number of threads actually started.
+ *
+ * Parameters:
+ * nThreads		Threads wanted, 1 to update on the caller alone
+ */
+int simThreads(int nThreads) {
+#ifdef SIM_INSTANCES
+    // Parts of a tick would see the state of whichever thread ran them,
+    // games side by side get their threads from the environment instead
+    (void) nThreads;
+    return 1;
+#endif
+
+    s_nThreads = workerStart(nThreads);
+
+    return s_nThreads;
+}
+
+/**
+ * Sets how often distant actors are updated, one tick in nEvery, 1 for
+ * every tick. They still end up where they would have been every tick.
+ *
+ * Parameters:
+ * nEvery		Ticks between updates, 1 to 256
+ */
+void simDetailRate(int nEvery) {
+    if (nEvery < 1)
+        nEvery = 1;
+    if (nEvery > 256)
+        nEvery = 256;
+
+    s_nDetailEvery = nEvery;
+}
+
+/**
+ * Returns how many partitions the awake actors of the last tick were
+ * split into
+ */
+int simPartitions(void) {
+    return s_nParts;
+}
+
+/**
+ * Frees everything the simulation holds
+ */
+void simShutdown(void) {
+    workerStop();
+    simStop();
+    navFree();
+    collisionFree();
+}
+
+/**
+ * Frees the game being played and its level, but not the derived data
+ * of the map
+ */
+void simStop(void) {
+    pathFree();
+    broadphaseFree();
+    regionFree();
+    actorFree();
+    levelFree(g_pLevel);
+
+    free(s_pOrder);
+    s_pOrder = NULL;
+    s_nOrderCap = 0;
+
+    free(s_pOwed);
+    free(s_pOwedX);
+    free(s_pOwedY);
+    free(s_pCatchUp);
+    s_pOwed = NULL;
+    s_pOwedX = NULL;
+    s_pOwedY = NULL;
+    s_pCatchUp = NULL;
+    s_nOwed = 0;
+    s_nOwedCap = 0;
+}
+
+/**
+ * Puts the map back as loaded and starts a new game
+ */
+void simReset(void) {
+    int i;
+
+    // Take back the gems, the derived data follows
+    levelRestore();
+
+    playerReset();
+
+    // Nothing to interpolate from after a reset
+    for (i = 0; i < g_sActors.count; i++) {
+        g_sActors.oldx[i] = g_sActors.x[i];
+        g_sActors.oldy[i] = g_sActors.y[i];
+    }
+
+    cameraFollow(g_sActors.x[PLAYER], g_sActors.y[PLAYER], g_sActors.w[PLAYER], g_sActors.h[PLAYER], & g_nMapX, & g_nMapY);
+}
+
+/**
+ * Sets how many players the game has and starts a new one for them
+ *
+ * Parameters:
+ * nPlayers		Players, 1 to MAX_PLAYERS
+ */
+void simPlayers(int nPlayers) {
+    if (nPlayers < 1)
+        nPlayers = 1;
+    if (nPlayers > MAX_PLAYERS)
+        nPlayers = MAX_PLAYERS;
+
+    g_nPlayers = nPlayers;
+    simReset();
+}
+
+/**
+ * Performs one fixed-length simulation tick
+ *
+ * Parameters:
+ * nInput		INPUT_* buttons held during the tick
+ */
+void simTick(int nInput) {
+    // Iterators
+    int i, n, p;
+
+    // Buttons of one player, and the span of the map in view
+    int nButtons;
+    int nLeft, nRight;
+    int bOver;
+
+    // Events are only reported for the tick that raised them
+    eventClear( & g_sEvents);
+
+    // Wake what is near the views, spawning as needed, and leave out the
+    // distant actors that wait for their turn
+    simViews( & nLeft, & nRight);
+    regionUpdate(nLeft, nRight, spawnActor);
+    simDetail();
+
+    // Update old locations
+    for (n = 0; n < g_nAwake; n++) {
+        i = g_pAwake[n];
+        g_sActors.oldx[i] = g_sActors.x[i];
+        g_sActors.oldy[i] = g_sActors.y[i];
+    }
+
+    for (p = 0; p < g_nPlayers; p++) {
+        nButtons = INPUT_PLAYER(nInput, p);
+
+        // Keep track of current state
+        g_sActors.moving[p] = 0;
+        g_sActors.jumpqueued[p] = 0;
+
+        // Only accept movements if player is alive
+        if (!g_sActors.alive[p])
+            continue;
+
+        if (nButtons & INPUT_LEFT) // Go left
+        {
+            g_sActors.x[p] -= 3;
+            g_sActors.dir[p] = 0;
+            g_sActors.moving[p] = 1;
+        } else if (nButtons & INPUT_RIGHT) // Go right
+        {
+            g_sActors.x[p] += 3;
+            g_sActors.dir[p] = 1;
+            g_sActors.moving[p] = 1;
+        } else {
+            g_sActors.frame[p] = 0; // Stop moving
+        }
+
+        // Wants to jump
+        if (nButtons & INPUT_JUMP)
+            g_sActors.jumpqueued[p] = 1;
+    }
+
+    // Count the time limit down every TICK_RATE ticks, the players die
+    // when it runs out
+    if (g_nTimeLeft > 0 && ++g_nSecondTicks == TICK_RATE) {
+        g_nSecondTicks = 0;
+        g_nTimeLeft--;
+
+        for (p = 0; g_nTimeLeft <= 0 && p < g_nPlayers; p++) {
+            if (g_sActors.alive[p]) {
+                g_sActors.alive[p] = 0;
+                eventPush( & g_sEvents, EVENT_TIMEUP, p, g_sActors.x[p], g_sActors.y[p], 0);
+            }
+        }
+    }
+
+    // Make up the ticks the distant actors missed, then step everything
+    // awake through this one
+    if (simCatchUp() != 0 || simPass(g_pAwake, g_nAwake) != 0)
+        return;
+    simCaughtUp();
+
+    // Dead plants are gone for good
+    for (n = 0; n < g_nAwake; n++) {
+        i = g_pAwake[n];
+        if (g_sActors.used[i] && !g_sActors.alive[i] && g_sActors.kind[i] != KIND_PLAYER) {
+            regionRemove(i);
+            actorRemove(actorHandle(i));
+        }
+    }
+
+    // Keep the region lists in step with the moves
+    regionRefresh();
+
+    // Determine scrolling offsets for the simulation
+    cameraFollow(g_sActors.x[PLAYER], g_sActors.y[PLAYER], g_sActors.w[PLAYER], g_sActors.h[PLAYER], & g_nMapX, & g_nMapY);
+
+    // Game is over for everyone, wait for a restart
+    bOver = 1;
+    for (p = 0; p < g_nPlayers; p++)
+        bOver &= !g_sActors.alive[p];
+    if (bOver && (nInput & INPUT_ANY_RESTART))
+        simReset();
+}
+
+/**
+ * Mixes a value into a running FNV-1a checksum
+ *
+ * Parameters:
+ * nHash		Checksum so far
+ * nValue		Value to mix in
+ */
+static unsigned int hashValue(unsigned int nHash, int nValue) {
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        nHash ^= (nValue >> (i * 8)) & 0xff;
+        nHash *= 16777619u;
+    }
+
+    return nHash;
+}
+
+/**
+ * Returns a checksum of the game state, equal for equal states
+ */
+unsigned int simChecksum(void) {
+    unsigned int nHash = 2166136261u;
+    int i;
+
+    for (i = 0; i < g_sActors.count; i++) {
+        if (!g_sActors.used[i])
+            continue;
+
+        nHash = hashValue(nHash, g_sActors.active[i]);
+        nHash = hashValue(nHash, g_sActors.alive[i]);
+        nHash = hashValue(nHash, g_sActors.x[i]);
+        nHash = hashValue(nHash, g_sActors.y[i]);
+        nHash = hashValue(nHash, g_sActors.dir[i]);
+        nHash = hashValue(nHash, g_sActors.jump[i]);
+        nHash = hashValue(nHash, g_sActors.moving[i]);
+        nHash = hashValue(nHash, g_sActors.frame[i]);
+        nHash = hashValue(nHash, g_sActors.framecount[i]);
+        nHash = hashValue(nHash, g_sActors.owed[i]);
+    }
+
+    nHash = hashValue(nHash, g_nPlayerScore);
+    nHash = hashValue(nHash, g_bVictory);
+    nHash = hashValue(nHash, g_nTimeLeft);
+    nHash = hashValue(nHash, g_nSecondTicks);
+    nHash = hashValue(nHash, g_nDetailPhase);
+
+    // Only games with a rival have a score for it
+    if (g_nPlayers > 1)
+        nHash = hashValue(nHash, g_nRivalScore);
+
+    return nHash;
+}
+
+/**
+ * Lists the variables holding the state of the game being played, in
+ * every module, returns how many. Games played side by side are swapped
+ * in and out of them.
+ *
+ * Parameters:
+ * pVars		Receives the variables, NULL to count them
+ */
+int simState(STATEVAR * pVars) {
+    int n = 0;
+
+    STATE_ADD(pVars, n, g_nPlayerScore);
+    STATE_ADD(pVars, n, g_nRivalScore);
+    STATE_ADD(pVars, n, g_bVictory);
+    STATE_ADD(pVars, n, g_nPlayers);
+    STATE_ADD(pVars, n, g_nTimeLeft);
+    STATE_ADD(pVars, n, g_nSecondTicks);
+    STATE_ADD(pVars, n, g_nDetailPhase);
+    STATE_ADD(pVars, n, g_nMapX);
+    STATE_ADD(pVars, n, g_nMapY);
+    STATE_ADD(pVars, n, s_aSeams);
+    STATE_ADD(pVars, n, s_nParts);
+    STATE_ADD(pVars, n, s_aPartEvents);
+    STATE_ADD(pVars, n, s_aViewX);
+    STATE_ADD(pVars, n, s_aViewY);
+    STATE_ADD(pVars, n, s_pOrder);
+    STATE_ADD(pVars, n, s_nOrderCap);
+    STATE_ADD(pVars, n, s_aRuns);
+    STATE_ADD(pVars, n, s_pStep);
+    STATE_ADD(pVars, n, s_nStep);
+    STATE_ADD(pVars, n, s_nDetailEvery);
+    STATE_ADD(pVars, n, s_pOwed);
+    STATE_ADD(pVars, n, s_pOwedX);
+    STATE_ADD(pVars, n, s_pOwedY);
+    STATE_ADD(pVars, n, s_pCatchUp);
+    STATE_ADD(pVars, n, s_nOwed);
+    STATE_ADD(pVars, n, s_nOwedCap);
+    STATE_ADD(pVars, n, s_nThreads);
+
+    STATE_MORE(pVars, n, eventState);
+    STATE_MORE(pVars, n, levelState);
+    STATE_MORE(pVars, n, actorState);
+    STATE_MORE(pVars, n, regionState);
+    STATE_MORE(pVars, n, broadphaseState);
+    STATE_MORE(pVars, n, pathState);
+
+    return n;
+}
@@ -0,0 +1,106 @@
+/**
+ * File:        sim.h
+ * Purpose:     Header file for sim.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _SIM_H_
+#define _SIM_H_
+
+// Include C stdlib
+#include <stdio.h>
+#include <stdlib.h>
+
+// Include headers for the simulation modules
+#include "level.h"
+#include "actor.h"
+#include "region.h"
+#include "collide.h"
+#include "broad.h"
+#include "nav.h"
+#include "path.h"
+#include "worker.h"
+#include "event.h"
+
+// Defines for the game
+#define JUMPIT	1600
+
+#define MAP_WIDTH 1500
+#define MAP_HEIGHT 25
+
+// The player is spawned first after every reset, so it keeps slot 0, and
+// a rival in a two-player game slot 1
+#define PLAYER 0
+#define RIVAL 1
+
+// Most players in one game
+#define MAX_PLAYERS 2
+
+// Simulation rate, in ticks per second
+#define TICK_RATE 60
+
+// Size of the view the camera follows, matches the game's screen mode
+#define VIEW_W 640
+#define VIEW_H 480
+
+// Actor sizes, matching the sprite frames in game.dat
+#define PLAYER_W 34
+#define PLAYER_H 42
+#define PLANT_W 50
+#define PLANT_H 42
+
+// Awake actors each worker thread needs before a tick is split up
+#define SIM_PARALLEL_MIN 256
+
+// Awake actors further than this from every view, in pixels, are only
+// updated one tick in SIM_DETAIL_EVERY, staggered by slot, and then make
+// up the ticks they missed. Set it to 1 to update every awake actor each
+// tick, simDetailRate changes it at run time. Beyond REGION_SLEEP_MARGIN
+// they are not updated at all.
+#define SIM_DETAIL_MARGIN 160
+#define SIM_DETAIL_EVERY 4
+
+// Input buttons for one tick
+#define INPUT_LEFT 0x01
+#define INPUT_RIGHT 0x02
+#define INPUT_JUMP 0x04
+#define INPUT_RESTART 0x08
+
+// Each player's buttons take INPUT_BITS bits of the tick's input, the
+// first player's the lowest
+#define INPUT_BITS 4
+#define INPUT_PLAYER(input, p) (((input) >> ((p) * INPUT_BITS)) & ((1 << INPUT_BITS) - 1))
+#define INPUT_ANY_RESTART (INPUT_RESTART | (INPUT_RESTART << INPUT_BITS))
+
+// Simulation state
+extern SIM_LOCAL int g_nPlayerScore;
+extern SIM_LOCAL int g_nRivalScore;
+extern SIM_LOCAL int g_nPlayers;
+extern SIM_LOCAL int g_bVictory;
+extern SIM_LOCAL int g_nTimeLeft;
+extern SIM_LOCAL int g_nSecondTicks;
+extern SIM_LOCAL int g_nDetailPhase;
+extern SIM_LOCAL int g_nMapX;
+extern SIM_LOCAL int g_nMapY;
+
+// Function declarations
+int simInit(const char * szMap);
+int simStart(LEVEL * pLevel);
+void simShutdown(void);
+void simStop(void);
+void simReset(void);
+void simPlayers(int nPlayers);
+void simTick(int nInput);
+unsigned int simChecksum(void);
+int simThreads(int nThreads);
+int simPartitions(void);
+void simDetailRate(int nEvery);
+int simState(STATEVAR * pVars);
+void cameraFollow(int x, int y, int w, int h, int * pMapX, int * pMapY);
+
+#endif
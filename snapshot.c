@@ -0,0 +1,120 @@
+/**
+ * File:        snapshot.c
+ * Purpose:     Packs the state of the game being played into one block of
+ *              memory and back
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include <string.h>
+
+#include "snapshot.h"
+#include "sim.h"
+
+/**
+ * Packs the state of the game being played into a buffer: score and
+ * camera, the actor pool, spawners and awake list, then the map cells.
+ * The collision plane and platform graph follow from the cells, and
+ * scratch space of the tick is left out. Returns the size of the
+ * snapshot; nothing is written if it does not fit, so a NULL buffer
+ * measures it.
+ *
+ * Snapshots are plain memory, for the same build of the game on the same
+ * machine, to be copied around freely.
+ *
+ * Parameters:
+ * pBuf			Buffer to pack into
+ * nCap			Size of the buffer
+ * nFlags		SNAP_* flags
+ */
+size_t snapSave(void * pBuf, size_t nCap, int nFlags) {
+    SNAPHEADER sHeader;
+    unsigned char * p = pBuf;
+    size_t nSize;
+    int bDelta = (nFlags & SNAP_DELTA) != 0;
+
+    nSize = sizeof(SNAPHEADER) + actorPack(NULL) + regionPack(NULL) + levelPack(NULL, bDelta);
+    if (pBuf == NULL || nCap < nSize)
+        return nSize;
+
+    memset( & sHeader, 0, sizeof(SNAPHEADER));
+    memcpy(sHeader.magic, "GDSS", 4);
+    sHeader.version = SNAP_VERSION;
+    sHeader.flags = nFlags;
+    sHeader.size = nSize;
+    sHeader.width = g_pLevel -> width;
+    sHeader.height = g_pLevel -> height;
+    sHeader.score = g_nPlayerScore;
+    sHeader.rivalscore = g_nRivalScore;
+    sHeader.players = g_nPlayers;
+    sHeader.victory = g_bVictory;
+    sHeader.timeleft = g_nTimeLeft;
+    sHeader.secondticks = g_nSecondTicks;
+    sHeader.detailphase = g_nDetailPhase;
+    sHeader.mapx = g_nMapX;
+    sHeader.mapy = g_nMapY;
+
+    memcpy(p, & sHeader, sizeof(SNAPHEADER));
+    p += sizeof(SNAPHEADER);
+    p += actorPack(p);
+    p += regionPack(p);
+    levelPack(p, bDelta);
+
+    return nSize;
+}
+
+/**
+ * Puts the game back as it was when a snapshot was taken. Cells that
+ * differ are marked dirty for the renderer. Returns 0 on success, -1 if
+ * the snapshot is damaged, of another version or of another map.
+ *
+ * Parameters:
+ * pBuf			Snapshot
+ * nSize		Size of the snapshot
+ */
+int snapLoad(const void * pBuf, size_t nSize) {
+    SNAPHEADER sHeader;
+    const unsigned char * p = pBuf;
+    size_t nRead;
+
+    if (nSize < sizeof(SNAPHEADER))
+        return -1;
+
+    memcpy( & sHeader, p, sizeof(SNAPHEADER));
+    if (memcmp(sHeader.magic, "GDSS", 4) || sHeader.version != SNAP_VERSION || sHeader.size != nSize ||
+        sHeader.width != g_pLevel -> width || sHeader.height != g_pLevel -> height)
+        return -1;
+    p += sizeof(SNAPHEADER);
+
+    nRead = actorUnpack(p);
+    if (nRead == 0)
+        return -1;
+    p += nRead;
+
+    nRead = regionUnpack(p);
+    if (nRead == 0)
+        return -1;
+    p += nRead;
+
+    if (levelUnpack(p, (sHeader.flags & SNAP_DELTA) != 0) == 0)
+        return -1;
+
+    g_nPlayerScore = sHeader.score;
+    g_nRivalScore = sHeader.rivalscore;
+    g_nPlayers = sHeader.players;
+    g_bVictory = sHeader.victory;
+    g_nTimeLeft = sHeader.timeleft;
+    g_nSecondTicks = sHeader.secondticks;
+    g_nDetailPhase = sHeader.detailphase;
+    g_nMapX = sHeader.mapx;
+    g_nMapY = sHeader.mapy;
+
+    // Events and searches in progress belong to the timeline being left
+    eventClear( & g_sEvents);
+    pathFree();
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+/**
+ * File:        snapshot.h
+ * Purpose:     Header file for snapshot.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Snapshot format, bump whenever the packed state changes
+#define SNAP_VERSION 6
+
+// Snapshot flags
+#define SNAP_DELTA 0x01 // Only the cells that differ from the pristine map
+
+// Start of every snapshot
+typedef struct SNAPHEADER
+{
+	char magic[4];
+	unsigned short version;
+	unsigned short flags;
+	unsigned int size;
+	int width, height;
+	int score;
+	int rivalscore;
+	int players;
+	int victory;
+	int timeleft;
+	int secondticks;
+	int detailphase;
+	int mapx, mapy;
+} SNAPHEADER;
+
+// Function declarations
+size_t snapSave(void * pBuf, size_t nCap, int nFlags);
+int snapLoad(const void * pBuf, size_t nSize);
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * File:        state.h
+ * Purpose:     Marks the mutable state of the simulation, so several games
+ *              can run side by side
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _STATE_H_
+#define _STATE_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+// Builds with SIM_INSTANCES give every thread its own copy of the state of
+// a game, so each thread can step a different game at the same time.
+// Everything else is shared: the loaded map and its collision and
+// platform data never change during play.
+#ifdef SIM_INSTANCES
+#define SIM_LOCAL __thread
+#else
+#define SIM_LOCAL
+#endif
+
+// Most variables making up the state of one game
+#define STATE_MAX_VARS 96
+
+// One variable of the state of a game, as seen by the calling thread
+typedef struct STATEVAR
+{
+	void * addr;
+	size_t size;
+} STATEVAR;
+
+// Lists a variable, counting it either way
+#define STATE_ADD(pVars, n, v) \
+	do { \
+		if ((pVars) != NULL) { \
+			(pVars)[n].addr = (void * ) & (v); \
+			(pVars)[n].size = sizeof(v); \
+		} \
+		(n)++; \
+	} while (0)
+
+// Lists the variables of a module after the ones listed so far
+#define STATE_MORE(pVars, n, pfnState) ((n) += pfnState((pVars) != NULL ? (pVars) + (n) : NULL))
+
+#endif
@@ -18,7 +18,5 @@
 
 // Function declarations
 BITMAP *grabFrame(BITMAP *src, int w, int h, int startx, int starty, int col, int frame);
-int mapCollision(int x, int y);
-int spikeCheck(int x, int y);
 
 #endif
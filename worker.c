@@ -0,0 +1,84 @@
+/**
+ * File:        worker.c
+ * Purpose:     Splits a job into parts run on the job system
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+#include "worker.h"
+
+// Job being split into parts
+typedef struct WORKJOB
+{
+	WORKFUNC pfn;
+	void * data;
+} WORKJOB;
+
+/**
+ * Runs a range of parts of a job
+ *
+ * Parameters:
+ * pData		Job the parts belong to
+ * nFirst		First part
+ * nLast		Part after the last
+ */
+static void workerParts(void * pData, int nFirst, int nLast) {
+    WORKJOB * pJob = (WORKJOB * ) pData;
+    int i;
+
+    for (i = nFirst; i < nLast; i++)
+        pJob -> pfn(pJob -> data, i);
+}
+
+/**
+ * Starts the pool. Returns the number of threads that will work on each
+ * job, the calling thread included.
+ *
+ * Parameters:
+ * nThreads		Threads wanted, the calling thread included
+ */
+int workerStart(int nThreads) {
+    return jobStart(nThreads);
+}
+
+/**
+ * Stops the threads of the pool, jobs run on the caller alone afterwards
+ */
+void workerStop(void) {
+    jobStop();
+}
+
+/**
+ * Returns the number of threads that work on each job, the caller included
+ */
+int workerCount(void) {
+    return jobThreads();
+}
+
+/**
+ * Runs every part of a job and waits for all of them to finish
+ *
+ * Parameters:
+ * pfnWork		Does one part of the job
+ * pData		Passed to every part
+ * nParts		Number of parts
+ */
+void workerRun(WORKFUNC pfnWork, void * pData, int nParts) {
+    WORKJOB sJob;
+    int i;
+
+    // Nobody to share with
+    if (jobThreads() == 1 || nParts <= 1) {
+        for (i = 0; i < nParts; i++)
+            pfnWork(pData, i);
+        return;
+    }
+
+    // Parts are already sized for the threads, hand out single ones
+    sJob.pfn = pfnWork;
+    sJob.data = pData;
+    jobFor(workerParts, & sJob, nParts, 1);
+}
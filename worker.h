@@ -0,0 +1,32 @@
+/**
+ * File:        worker.h
+ * Purpose:     Header file for worker.c
+ *
+ * Author:      Lionel Pinkhard
+ * Date:        October 19, 2026
+ * Version:     1.0
+ *
+ */
+
+// Only include this header once
+#ifndef _WORKER_H_
+#define _WORKER_H_
+
+// Include C stdlib
+#include <stdlib.h>
+
+#include "job.h"
+
+// Most threads in the pool, the calling thread included
+#define WORKER_MAX JOB_MAX_THREADS
+
+// Work on one part of a job, parts run in any order and on any thread
+typedef void (* WORKFUNC)(void * pData, int nPart);
+
+// Function declarations
+int workerStart(int nThreads);
+void workerStop(void);
+int workerCount(void);
+void workerRun(WORKFUNC pfnWork, void * pData, int nParts);
+
+#endif